@@ -66,6 +66,27 @@ binary_op<signs...>::binary_op(calc_node&& a, calc_node&& b)
     : impl(std::make_unique<detail::binary_op_impl>(std::move(a),
                                                     std::move(b))) {}
 
+}  // namespace evaler
+
+namespace base {
+
+// Nodes are just owning pointers to their children, so nodes and whole
+// `calc_node` are relocated as raw bytes.
+template <evaler::math_func func>
+struct is_trivially_relocatable<evaler::unary_op<func>>
+    : is_trivially_relocatable<decltype(evaler::unary_op<func>::expr)> {};
+
+template <char... signs>
+struct is_trivially_relocatable<evaler::binary_op<signs...>>
+    : is_trivially_relocatable<decltype(evaler::binary_op<signs...>::impl)> {};
+
+}  // namespace base
+
+namespace evaler {
+
+static_assert(base::is_trivially_relocatable_v<calc_node>,
+              "calc_node must be trivially relocatable.");
+
 // -------------------- PARSING --------------------
 
 // Symbols '`', '|' are reserved
@@ -125,35 +146,42 @@ inline std::string print(const calc_node& n, const int indent) {
 // -------------------- EVALUATION --------------------
 
 // Goes through the calculation tree and returns the result.
-inline double eval(const calc_node& n) {
-  struct visitor {
-    auto operator()(const double value) { return value; };
-    auto operator()(const binary_op<'+'>& value) {
-      return eval(value.impl->left) + eval(value.impl->right);
-    };
-    auto operator()(const binary_op<'-'>& value) {
-      return eval(value.impl->left) - eval(value.impl->right);
-    };
-    auto operator()(const binary_op<'*'>& value) {
-      return eval(value.impl->left) * eval(value.impl->right);
-    };
-    auto operator()(const binary_op<'/'>& value) {
-      return eval(value.impl->left) / eval(value.impl->right);
-    };
-    auto operator()(const binary_op<'*', '*'>& value) {
-      return std::pow(eval(value.impl->left), eval(value.impl->right));
-    };
-    auto operator()(const unary_op<math_func::sin>& value) {
-      return std::sin(eval(*value.expr));
-    }
-    auto operator()(const unary_op<math_func::cos>& value) {
-      return std::cos(eval(*value.expr));
-    }
-    auto operator()(const unary_op<math_func::log>& value) {
-      return std::log(eval(*value.expr));
-    }
+double eval(const calc_node& n);
+
+namespace detail {
+
+struct eval_visitor {
+  auto operator()(const double value) { return value; };
+  auto operator()(const binary_op<'+'>& value) {
+    return eval(value.impl->left) + eval(value.impl->right);
+  };
+  auto operator()(const binary_op<'-'>& value) {
+    return eval(value.impl->left) - eval(value.impl->right);
   };
-  return base::visit(visitor{}, n);
+  auto operator()(const binary_op<'*'>& value) {
+    return eval(value.impl->left) * eval(value.impl->right);
+  };
+  auto operator()(const binary_op<'/'>& value) {
+    return eval(value.impl->left) / eval(value.impl->right);
+  };
+  auto operator()(const binary_op<'*', '*'>& value) {
+    return std::pow(eval(value.impl->left), eval(value.impl->right));
+  };
+  auto operator()(const unary_op<math_func::sin>& value) {
+    return std::sin(eval(*value.expr));
+  }
+  auto operator()(const unary_op<math_func::cos>& value) {
+    return std::cos(eval(*value.expr));
+  }
+  auto operator()(const unary_op<math_func::log>& value) {
+    return std::log(eval(*value.expr));
+  }
+};
+
+}  // namespace detail
+
+inline double eval(const calc_node& n) {
+  return base::visit(detail::eval_visitor{}, n);
 }
 
 // -------------------- DYNAMIC PART --------------------
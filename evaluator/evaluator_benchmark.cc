@@ -1,5 +1,9 @@
+#include <vector>
+
 #include "benchmark/benchmark.h"
 #include "evaluator.h"
+#include "variant/parallel_visit.h"
+#include "variant/relocating_vector.h"
 
 namespace {
 
@@ -20,6 +24,17 @@ const auto tree_dyn = evaler::convert_to_dynamic(tree);
 const auto large_tree = evaler::parse(create_big_data());
 const auto large_tree_dyn = evaler::convert_to_dynamic(large_tree);
 
+std::vector<evaler::calc_node> create_forest(std::size_t size) {
+  auto result = std::vector<evaler::calc_node>{};
+  result.reserve(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    result.push_back(evaler::parse(test_data));
+  }
+  return result;
+}
+
+const auto forest = create_forest(1 << 16);
+
 }  // namespace
 
 void make_stupid_arr() {
@@ -71,11 +86,50 @@ void BM_dynamic_eval_big(benchmark::State& state) {
   }
 }
 
+// Sum of many independent trees on `state.range(0)` threads.
+void BM_parallel_eval(benchmark::State& state) {
+  base::thread_pool pool{static_cast<std::size_t>(state.range(0))};
+  const auto options = base::parallel_options{&pool, 1024};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base::parallel_visit_reduce(
+        forest, 0.0, [](double a, double b) { return a + b; },
+        evaler::detail::eval_visitor{}, options));
+  }
+  state.SetItemsProcessed(state.iterations() * forest.size());
+}
+
+// Appends nodes one by one, so the time goes mostly to the reallocations.
+template <class Vector>
+void BM_node_vector_growth(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    auto nodes = Vector{};
+    for (std::size_t i = 0; i < n; ++i) {
+      nodes.push_back(evaler::calc_node{1.0 * i});
+    }
+    benchmark::DoNotOptimize(nodes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
 BENCHMARK(BM_static_eval_small);
 BENCHMARK(BM_dynamic_eval_small);
 BENCHMARK(BM_static_eval);
 BENCHMARK(BM_dynamic_eval);
 BENCHMARK(BM_static_eval_big);
 BENCHMARK(BM_dynamic_eval_big);
+BENCHMARK(BM_parallel_eval)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_node_vector_growth, std::vector<evaler::calc_node>)
+    ->Range(1 << 10, 1 << 22)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_node_vector_growth,
+                   base::relocating_vector<evaler::calc_node>)
+    ->Range(1 << 10, 1 << 22)
+    ->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "variant.h"
+
+namespace base {
+
+namespace detail {
+
+// Canonical object representation of a variant of trivially copyable
+// alternatives: bytes of the active alternative padded with zeros up to the
+// largest one, followed by the stored index. Variants holding the same bytes
+// of the same alternative are encoded identically, so the encoded words can be
+// compared as a whole. Empty alternatives contribute no bytes. Valueless
+// variants have no encoding: `encode` raises `bad_variant_access` for them.
+template <class... Ts>
+struct atomic_variant_codec {
+  using index_type = index_type_t<sizeof...(Ts)>;
+
+  static constexpr std::size_t payload_size = std::max({sizeof(Ts)...});
+  static constexpr std::size_t words =
+      (payload_size + sizeof(index_type) + sizeof(std::uint64_t) - 1) /
+      sizeof(std::uint64_t);
+
+  using repr = std::array<std::uint64_t, words>;
+
+  static repr encode(const variant<Ts...>& v) {
+    if (v.valueless_by_exception()) {
+      raise<bad_variant_access>();
+    }
+    repr result{};
+    auto* const bytes = reinterpret_cast<unsigned char*>(result.data());
+    dispatch_index<void, sizeof...(Ts)>(v.index(), [&v, bytes](auto i) {
+      const auto& value = variant_accessor::get<decltype(i)::value>(v);
+      using T = std::decay_t<decltype(value)>;
+      // The byte of an empty class is indeterminate.
+      std::memcpy(bytes, &value, std::is_empty<T>::value ? 0 : sizeof(T));
+    });
+    const auto stored_index = static_cast<index_type>(v.index() + 1);
+    std::memcpy(bytes + payload_size, &stored_index, sizeof(index_type));
+    return result;
+  }
+
+  static variant<Ts...> decode(const repr& r) noexcept {
+    const auto* const bytes = reinterpret_cast<const unsigned char*>(r.data());
+    index_type stored_index;
+    std::memcpy(&stored_index, bytes + payload_size, sizeof(index_type));
+    return dispatch_index<variant<Ts...>, sizeof...(Ts)>(
+        static_cast<std::size_t>(stored_index) - 1, [bytes](auto i) {
+          constexpr std::size_t I = decltype(i)::value;
+          using T = alternative_type_t<I, Ts...>;
+          std::aligned_storage_t<sizeof(T), alignof(T)> value;
+          std::memcpy(&value, bytes, sizeof(T));
+          return variant<Ts...>(in_place_index<I>,
+                                reinterpret_cast<const T&>(value));
+        });
+  }
+};
+
+// Atomic array of `n` words. Generic case is a seqlock: writers serialize on
+// an odd sequence number, readers retry until they see the same even one
+// before and after copying the words.
+template <std::size_t n>
+class atomic_words {
+ public:
+  using repr = std::array<std::uint64_t, n>;
+
+  static constexpr bool is_always_lock_free = false;
+
+  explicit atomic_words(const repr& value) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      words_[i].store(value[i], std::memory_order_relaxed);
+    }
+  }
+
+  repr load() const noexcept {
+    repr result;
+    for (;;) {
+      const std::uint64_t seq = sequence_.load(std::memory_order_acquire);
+      if ((seq & 1) == 0) {
+        read(result);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == seq) {
+          return result;
+        }
+      }
+    }
+  }
+
+  void store(const repr& value) noexcept {
+    const std::uint64_t seq = lock();
+    write(value);
+    unlock(seq);
+  }
+
+  repr exchange(const repr& value) noexcept {
+    const std::uint64_t seq = lock();
+    repr result;
+    read(result);
+    write(value);
+    unlock(seq);
+    return result;
+  }
+
+  bool compare_exchange(repr& expected, const repr& desired) noexcept {
+    const std::uint64_t seq = lock();
+    repr current;
+    read(current);
+    const bool equal = current == expected;
+    if (equal) {
+      write(desired);
+    } else {
+      expected = current;
+    }
+    unlock(seq);
+    return equal;
+  }
+
+ private:
+  // Returns the even sequence number seen before locking.
+  std::uint64_t lock() noexcept {
+    for (;;) {
+      std::uint64_t seq = sequence_.load(std::memory_order_relaxed);
+      if ((seq & 1) == 0 &&
+          sequence_.compare_exchange_weak(seq, seq + 1,
+                                          std::memory_order_acquire)) {
+        std::atomic_thread_fence(std::memory_order_release);
+        return seq;
+      }
+    }
+  }
+
+  void unlock(std::uint64_t seq) noexcept {
+    sequence_.store(seq + 2, std::memory_order_release);
+  }
+
+  void read(repr& result) const noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      result[i] = words_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  void write(const repr& value) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      words_[i].store(value[i], std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<std::uint64_t> sequence_{0};
+  std::atomic<std::uint64_t> words_[n];
+};
+
+// Single word: plain `std::atomic`.
+template <>
+class atomic_words<1> {
+ public:
+  using repr = std::array<std::uint64_t, 1>;
+
+  static constexpr bool is_always_lock_free = ATOMIC_LLONG_LOCK_FREE == 2;
+
+  explicit atomic_words(const repr& value) noexcept : word_(value[0]) {}
+
+  repr load() const noexcept { return {{word_.load()}}; }
+
+  void store(const repr& value) noexcept { word_.store(value[0]); }
+
+  repr exchange(const repr& value) noexcept {
+    return {{word_.exchange(value[0])}};
+  }
+
+  bool compare_exchange(repr& expected, const repr& desired) noexcept {
+    return word_.compare_exchange_strong(expected[0], desired[0]);
+  }
+
+ private:
+  std::atomic<std::uint64_t> word_;
+};
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+
+// Two words: 16-byte compare-and-swap (`cmpxchg16b` with `-mcx16` on x86-64).
+// Loads are compare-and-swaps too, so they write the cache line.
+template <>
+class atomic_words<2> {
+  __extension__ using word_pair = unsigned __int128;
+
+ public:
+  using repr = std::array<std::uint64_t, 2>;
+
+  static constexpr bool is_always_lock_free = true;
+
+  explicit atomic_words(const repr& value) noexcept : pair_(pack(value)) {}
+
+  repr load() const noexcept {
+    return unpack(__sync_val_compare_and_swap(&pair_, 0, 0));
+  }
+
+  void store(const repr& value) noexcept { exchange(value); }
+
+  repr exchange(const repr& value) noexcept {
+    const word_pair desired = pack(value);
+    // Any guess will do, the first compare-and-swap reads the actual value
+    // atomically if it's wrong.
+    word_pair current = 0;
+    for (;;) {
+      const word_pair seen =
+          __sync_val_compare_and_swap(&pair_, current, desired);
+      if (seen == current) {
+        return unpack(current);
+      }
+      current = seen;
+    }
+  }
+
+  bool compare_exchange(repr& expected, const repr& desired) noexcept {
+    const word_pair old = pack(expected);
+    const word_pair seen =
+        __sync_val_compare_and_swap(&pair_, old, pack(desired));
+    if (seen == old) {
+      return true;
+    }
+    expected = unpack(seen);
+    return false;
+  }
+
+ private:
+  static word_pair pack(const repr& value) noexcept {
+    word_pair result;
+    std::memcpy(&result, value.data(), sizeof(result));
+    return result;
+  }
+
+  static repr unpack(word_pair value) noexcept {
+    repr result;
+    std::memcpy(result.data(), &value, sizeof(value));
+    return result;
+  }
+
+  alignas(16) mutable word_pair pair_;
+};
+
+#endif
+
+}  // namespace detail
+
+// Atomic variant of small trivially copyable alternatives, such as a status
+// word or a configuration value published by one thread and read by others.
+//
+// The variant is encoded as the bytes of the active alternative plus its index
+// and kept in the smallest atomic able to hold them: a single `std::atomic`
+// word, a 16-byte compare-and-swap when the target has one (e.g. x86-64 with
+// `-mcx16`) or a seqlock otherwise. `is_always_lock_free` tells whether the
+// seqlock is used.
+//
+// The 16-byte compare-and-swap is only enabled by `-mcx16` (or an `-march`
+// implying it), which the default build doesn't pass, so by default variants
+// taking two words, e.g. of `std::int64_t` and `double`, use the seqlock and
+// aren't lock-free. Build the users with `-mcx16` to get the lock-free path.
+//
+// Every operation acts on the whole (index, value) pair. Loads acquire, stores
+// release. Like `std::atomic`, `compare_exchange_strong` compares object
+// representations, so e.g. `0.0` and `-0.0` are different doubles for it.
+// Operations taking a valueless variant raise `bad_variant_access` and leave
+// the atomic unchanged.
+template <class... Ts>
+class atomic_variant {
+  static_assert(base::conjunction_v<std::is_trivially_copyable<Ts>...>,
+                "atomic_variant alternatives must be trivially copyable.");
+
+  using codec = detail::atomic_variant_codec<Ts...>;
+  using storage_type = detail::atomic_words<codec::words>;
+
+ public:
+  using value_type = variant<Ts...>;
+
+  static constexpr bool is_always_lock_free = storage_type::is_always_lock_free;
+
+  atomic_variant() noexcept : atomic_variant(value_type{}) {}
+
+  atomic_variant(const value_type& value) : storage_(codec::encode(value)) {}
+
+  atomic_variant(const atomic_variant&) = delete;
+  atomic_variant& operator=(const atomic_variant&) = delete;
+
+  bool is_lock_free() const noexcept { return is_always_lock_free; }
+
+  value_type load() const noexcept { return codec::decode(storage_.load()); }
+
+  void store(const value_type& value) {
+    storage_.store(codec::encode(value));
+  }
+
+  value_type exchange(const value_type& value) {
+    return codec::decode(storage_.exchange(codec::encode(value)));
+  }
+
+  // Replaces the value with `desired` if it's equal to `expected`, otherwise
+  // loads it into `expected`.
+  bool compare_exchange_strong(value_type& expected,
+                               const value_type& desired) {
+    auto repr = codec::encode(expected);
+    if (storage_.compare_exchange(repr, codec::encode(desired))) {
+      return true;
+    }
+    expected = codec::decode(repr);
+    return false;
+  }
+
+  // Visits a consistent snapshot of the value.
+  template <class F>
+  decltype(auto) visit(F&& f) const {
+    return base::visit(std::forward<F>(f), load());
+  }
+
+ private:
+  storage_type storage_;
+};
+
+template <class... Ts>
+constexpr bool atomic_variant<Ts...>::is_always_lock_free;
+
+}  // namespace base
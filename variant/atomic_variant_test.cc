@@ -0,0 +1,233 @@
+#include "atomic_variant.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+namespace {
+
+using word_var_t = base::variant<std::int32_t, float>;
+using pair_var_t = base::variant<std::int64_t, double, base::monostate>;
+using triple_t = std::array<std::uint64_t, 3>;
+using triple_var_t = base::variant<triple_t, std::uint32_t>;
+
+static_assert(base::atomic_variant<std::int32_t, float>::is_always_lock_free,
+              "");
+static_assert(
+    !base::atomic_variant<triple_t, std::uint32_t>::is_always_lock_free, "");
+// Two words are lock-free only with the 16-byte compare-and-swap, i.e. in the
+// `atomic_variant_cx16_test` build on x86-64.
+constexpr bool pair_lock_free =
+    base::atomic_variant<std::int64_t, double,
+                         base::monostate>::is_always_lock_free;
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+static_assert(pair_lock_free, "");
+#else
+static_assert(!pair_lock_free, "");
+#endif
+#if BASE_VARIANT_TEST_CX16 && defined(__x86_64__)
+static_assert(pair_lock_free, "-mcx16 should enable 16-byte atomics.");
+#endif
+
+template <class V>
+struct atomic_of;
+
+template <class... Ts>
+struct atomic_of<base::variant<Ts...>> {
+  using type = base::atomic_variant<Ts...>;
+};
+
+template <class V>
+using atomic_of_t = typename atomic_of<V>::type;
+
+// Stores, exchanges and compare-exchanges `a`, `b` and `c`, which must be
+// different.
+template <class V>
+void check_operations(const V& a, const V& b, const V& c) {
+  atomic_of_t<V> value{a};
+  REQUIRE(value.load() == a);
+
+  value.store(b);
+  REQUIRE(value.load() == b);
+
+  REQUIRE(value.exchange(c) == b);
+  REQUIRE(value.load() == c);
+
+  V expected = a;
+  REQUIRE_FALSE(value.compare_exchange_strong(expected, b));
+  REQUIRE(expected == c);
+  REQUIRE(value.load() == c);
+
+  REQUIRE(value.compare_exchange_strong(expected, a));
+  REQUIRE(expected == c);
+  REQUIRE(value.load() == a);
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+// Converts to `std::int32_t` by throwing, so emplacing it leaves a variant
+// valueless.
+struct throwing_int {
+  operator std::int32_t() const { throw std::runtime_error{"throwing_int"}; }
+};
+#endif
+
+struct size_visitor {
+  std::size_t operator()(const triple_t& x) const { return x.size(); }
+  std::size_t operator()(std::uint32_t) const { return 1; }
+};
+
+}  // namespace
+
+TEST_CASE("Atomic variant operations") {
+  SECTION("single word") {
+    check_operations(word_var_t{std::int32_t{1}}, word_var_t{1.0f},
+                     word_var_t{std::int32_t{2}});
+  }
+
+  SECTION("two words") {
+    check_operations(pair_var_t{std::int64_t{-1}}, pair_var_t{-1.0},
+                     pair_var_t{base::monostate{}});
+  }
+
+  SECTION("seqlock") {
+    check_operations(triple_var_t{triple_t{{1, 2, 3}}},
+                     triple_var_t{std::uint32_t{1}},
+                     triple_var_t{triple_t{{1, 2, 4}}});
+  }
+
+  SECTION("compares the whole representation") {
+    base::atomic_variant<std::int64_t, double, base::monostate> value{
+        pair_var_t{0.0}};
+    pair_var_t expected{-0.0};
+    REQUIRE_FALSE(value.compare_exchange_strong(expected, pair_var_t{1.0}));
+    REQUIRE(std::signbit(base::get<double>(expected)) == false);
+
+    // Same bytes, different alternatives.
+    base::atomic_variant<std::int32_t, std::uint32_t> word{std::int32_t{0}};
+    base::variant<std::int32_t, std::uint32_t> other{std::uint32_t{0}};
+    REQUIRE_FALSE(word.compare_exchange_strong(other, std::uint32_t{1}));
+    REQUIRE(other.index() == 0);
+  }
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  SECTION("valueless") {
+    word_var_t valueless{1.0f};
+    REQUIRE_THROWS_AS(valueless.emplace<std::int32_t>(throwing_int{}),
+                      std::runtime_error);
+    REQUIRE(valueless.valueless_by_exception());
+
+    using atomic_t = base::atomic_variant<std::int32_t, float>;
+    REQUIRE_THROWS_AS(atomic_t{valueless}, base::bad_variant_access);
+
+    atomic_t value{word_var_t{2.0f}};
+    REQUIRE_THROWS_AS(value.store(valueless), base::bad_variant_access);
+    REQUIRE_THROWS_AS(value.exchange(valueless), base::bad_variant_access);
+    word_var_t expected{2.0f};
+    REQUIRE_THROWS_AS(value.compare_exchange_strong(expected, valueless),
+                      base::bad_variant_access);
+    REQUIRE_THROWS_AS(value.compare_exchange_strong(valueless, expected),
+                      base::bad_variant_access);
+    REQUIRE(value.load() == word_var_t{2.0f});
+  }
+#endif
+
+  SECTION("visit") {
+    base::atomic_variant<triple_t, std::uint32_t> value;
+    REQUIRE(value.visit(size_visitor{}) == 3);
+    value.store(std::uint32_t{5});
+    REQUIRE(value.visit(size_visitor{}) == 1);
+  }
+}
+
+namespace {
+
+// Writer publishes values whose parts are all equal, readers check that no
+// snapshot mixes parts of different stores.
+template <class V, class Make, class Check>
+void check_snapshots(Make make, Check check) {
+  constexpr int stores = 20000;
+  constexpr int readers = 3;
+  atomic_of_t<V> value{make(0)};
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&] {
+      while (!done.load()) {
+        if (!check(value.load())) {
+          ++torn;
+        }
+      }
+    });
+  }
+  for (int i = 1; i <= stores; ++i) {
+    value.store(make(i));
+  }
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(torn.load() == 0);
+  REQUIRE(check(value.load()));
+}
+
+}  // namespace
+
+TEST_CASE("Atomic variant concurrent access") {
+  SECTION("snapshots") {
+    check_snapshots<pair_var_t>(
+        [](int i) {
+          return i % 2 == 0 ? pair_var_t{std::int64_t{i} << 32 | i}
+                            : pair_var_t{static_cast<double>(i)};
+        },
+        [](const pair_var_t& v) {
+          if (const auto* x = base::get_if<std::int64_t>(&v)) {
+            return (*x >> 32) == (*x & 0xffffffff);
+          }
+          return base::get<double>(v) == static_cast<int>(base::get<double>(v));
+        });
+
+    check_snapshots<triple_var_t>(
+        [](int i) {
+          const auto x = static_cast<std::uint64_t>(i);
+          return i % 3 == 0 ? triple_var_t{static_cast<std::uint32_t>(x)}
+                            : triple_var_t{triple_t{{x, x, x}}};
+        },
+        [](const triple_var_t& v) {
+          if (const auto* x = base::get_if<triple_t>(&v)) {
+            return (*x)[0] == (*x)[1] && (*x)[1] == (*x)[2];
+          }
+          return base::get<std::uint32_t>(v) % 3 == 0;
+        });
+  }
+
+  SECTION("compare-exchange increments") {
+    constexpr int threads_count = 4;
+    constexpr int increments = 5000;
+    base::atomic_variant<triple_t, std::uint32_t> value{std::uint32_t{0}};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threads_count; ++i) {
+      threads.emplace_back([&value] {
+        for (int j = 0; j < increments; ++j) {
+          triple_var_t expected = value.load();
+          while (!value.compare_exchange_strong(
+              expected, base::get<std::uint32_t>(expected) + 1)) {
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    REQUIRE(base::get<std::uint32_t>(value.load()) ==
+            threads_count * increments);
+  }
+}
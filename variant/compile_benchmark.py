@@ -0,0 +1,191 @@
+"""Compile-time and code-size benchmark for variant and visit.
+
+Generates translation units holding a variant of N distinct alternatives
+visited by 1, 2 or 3 variants at once, compiles each of them and writes a JSON
+report with compile wall time, peak compiler memory and object size.
+
+Usage:
+  bazel run variant:compile_benchmark -- --output=/tmp/report.json
+  bazel run variant:compile_benchmark -- --alternatives=8,32 --ways=1,2
+
+Configurations whose visit has more than --max-handlers leaf handlers (e.g.
+three-way visit of 256 alternatives) are reported as skipped.
+"""
+
+import argparse
+import json
+import os
+import platform
+import shlex
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+_SOURCE_TEMPLATE = """\
+#include "variant/variant.h"
+
+// Types have external linkage so that run() and the handlers it references
+// are emitted.
+template <int I>
+struct alt {{
+  int value;
+}};
+
+template <class>
+struct make_variant;
+
+template <int... Is>
+struct make_variant<std::integer_sequence<int, Is...>> {{
+  using type = base::variant<alt<Is>...>;
+}};
+
+using var_t =
+    typename make_variant<std::make_integer_sequence<int, {alternatives}>>::type;
+
+struct visitor {{
+  template <class... Alts>
+  int operator()(const Alts&... alts) const {{
+    int sum = 0;
+    (void)std::initializer_list<int>{{(sum += alts.value, 0)...}};
+    return sum;
+  }}
+}};
+
+int run({params}) {{ return base::visit{result}(visitor{{}}, {args}); }}
+"""
+
+
+def _generate_source(alternatives, ways, explicit_result):
+    names = ["v{}".format(i) for i in range(ways)]
+    return _SOURCE_TEMPLATE.format(
+        alternatives=alternatives,
+        result="<int>" if explicit_result else "",
+        params=", ".join("const var_t& " + n for n in names),
+        args=", ".join(names))
+
+
+def _text_size(obj):
+    try:
+        out = subprocess.run(["size", obj], stdout=subprocess.PIPE,
+                             stderr=subprocess.DEVNULL,
+                             universal_newlines=True, check=True).stdout
+        return int(out.splitlines()[1].split()[0])
+    except (OSError, subprocess.CalledProcessError, IndexError, ValueError):
+        return None
+
+
+def _compile(cmd, timeout):
+    """Runs the compiler, returns (succeeded, wall seconds, peak rss, stderr).
+
+    The child is reaped with wait4 so peak memory belongs to this compiler
+    process only, not to every child spawned so far.
+    """
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, stderr=subprocess.PIPE)
+    timer = threading.Timer(timeout, proc.kill)
+    timer.start()
+    try:
+        stderr = proc.stderr.read().decode(errors="replace")
+        _, status, usage = os.wait4(proc.pid, 0)
+    finally:
+        timer.cancel()
+    wall = time.monotonic() - start
+    proc.returncode = status
+    succeeded = os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
+    # ru_maxrss is in KiB on Linux and in bytes on macOS.
+    rss_kib = usage.ru_maxrss
+    if sys.platform == "darwin":
+        rss_kib //= 1024
+    return succeeded, wall, rss_kib, stderr
+
+
+def _measure(args, alternatives, ways, workdir):
+    base_name = "variant_{}x{}".format(alternatives, ways)
+    src = os.path.join(workdir, base_name + ".cc")
+    obj = os.path.join(workdir, base_name + ".o")
+    with open(src, "w") as f:
+        f.write(_generate_source(alternatives, ways, args.explicit_result))
+    cmd = ([args.cxx] + shlex.split(args.cxxflags) +
+           ["-I", args.include_root, "-c", src, "-o", obj])
+    succeeded, wall, rss_kib, stderr = _compile(cmd, args.timeout)
+    result = {
+        "alternatives": alternatives,
+        "ways": ways,
+        "handlers": (alternatives + 1)**ways,
+        "wall_seconds": round(wall, 3),
+    }
+    if not succeeded:
+        result["status"] = "failed"
+        result["error"] = stderr[-2000:]
+        return result
+    result.update({
+        "status": "ok",
+        "peak_rss_kib": rss_kib,
+        "object_bytes": os.path.getsize(obj),
+        "text_bytes": _text_size(obj),
+    })
+    return result
+
+
+def _int_list(value):
+    return [int(v) for v in value.split(",") if v]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--cxxflags", default="-std=c++14 -O2")
+    parser.add_argument("--alternatives", type=_int_list,
+                        default=[8, 32, 128, 256])
+    parser.add_argument("--ways", type=_int_list, default=[1, 2, 3])
+    parser.add_argument("--explicit-result", action="store_true",
+                        help="use visit<R> instead of deducing the result")
+    parser.add_argument("--max-handlers", type=int, default=1 << 16)
+    parser.add_argument("--timeout", type=float, default=1800)
+    parser.add_argument("--include-root", default=os.getcwd(),
+                        help="directory containing variant/ and util/")
+    parser.add_argument("--output", help="report path (default: stdout)")
+    args = parser.parse_args()
+
+    results = []
+    with tempfile.TemporaryDirectory() as workdir:
+        for ways in args.ways:
+            for alternatives in args.alternatives:
+                handlers = (alternatives + 1)**ways
+                if handlers > args.max_handlers:
+                    results.append({
+                        "alternatives": alternatives,
+                        "ways": ways,
+                        "handlers": handlers,
+                        "status": "skipped",
+                    })
+                    continue
+                result = _measure(args, alternatives, ways, workdir)
+                print("{alternatives:>4} alternatives, {ways}-way: "
+                      "{status} {wall_seconds}s".format(**result),
+                      file=sys.stderr)
+                results.append(result)
+
+    report = {
+        "compiler": args.cxx,
+        "cxxflags": args.cxxflags,
+        "explicit_result": args.explicit_result,
+        "platform": platform.platform(),
+        "results": results,
+    }
+    text = json.dumps(report, indent=2)
+    if args.output:
+        # `bazel run` starts in the runfiles tree; resolve relative paths
+        # against the directory the command was invoked from.
+        output = os.path.join(os.environ.get("BUILD_WORKING_DIRECTORY", ""),
+                              args.output)
+        with open(output, "w") as f:
+            f.write(text + "\n")
+    else:
+        print(text)
+
+
+if __name__ == "__main__":
+    main()
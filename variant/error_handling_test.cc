@@ -0,0 +1,89 @@
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "catch2/catch_all.hpp"
+#include "relocating_vector.h"
+#include "small_variant.h"
+#include "test_util.h"
+#include "variant.h"
+#include "variant_queue.h"
+#include "variant_vector.h"
+#include "visit_each.h"
+
+namespace {
+
+using base::testing::jump_back;
+using base::testing::raised_error;
+
+using var_t = base::variant<int, std::string>;
+
+struct length {
+  std::size_t operator()(int) const { return 1; }
+  std::size_t operator()(const std::string& value) const {
+    return value.size();
+  }
+};
+
+}  // namespace
+
+TEST_CASE("Try get") {
+  var_t v{42};
+  const var_t& cv = v;
+
+  REQUIRE(*base::try_get<0>(v) == 42);
+  REQUIRE(*base::try_get<int>(cv) == 42);
+  REQUIRE(base::try_get<1>(v) == nullptr);
+  REQUIRE(base::try_get<std::string>(cv) == nullptr);
+
+  v = std::string{"abc"};
+  *base::try_get<std::string>(v) += "d";
+  REQUIRE(*base::try_get<1>(cv) == "abcd");
+  REQUIRE(base::try_get<int>(v) == nullptr);
+}
+
+TEST_CASE("Misuse is reported") {
+  var_t v{std::string{"abc"}};
+  REQUIRE(raised_error([&v] { base::get<int>(v); }) == "bad_variant_access");
+  REQUIRE(raised_error([&v] { base::get<std::string>(v); }).empty());
+
+  base::variant_vector<int, double> values;
+  values.push_back(1.0);
+  REQUIRE(raised_error([&values] { values.get<int>(0); }) ==
+          "bad_variant_access");
+}
+
+TEST_CASE("Error handler replacement") {
+  const base::variant_error_handler previous =
+      base::set_variant_error_handler(&jump_back);
+  REQUIRE(base::set_variant_error_handler(nullptr) == &jump_back);
+  REQUIRE(base::set_variant_error_handler(previous) != &jump_back);
+}
+
+TEST_CASE("Operations without errors") {
+  var_t a{1};
+  var_t b{std::string{"xy"}};
+  a.swap(b);
+  REQUIRE(base::visit(length{}, a) == 2);
+  b.emplace<std::string>(3, 'z');
+  a = b;
+  REQUIRE(a == b);
+  REQUIRE(std::hash<var_t>{}(a) == std::hash<var_t>{}(b));
+
+  base::relocating_vector<var_t> vector;
+  for (int i = 0; i < 100; ++i) {
+    vector.emplace_back(std::to_string(i));
+  }
+  std::size_t total = 0;
+  base::visit_each(vector, [&total](const auto& x) { total += length{}(x); });
+  REQUIRE(total == 190);
+
+  base::small_variant<8, int, std::string> small{std::string(100, 'x')};
+  REQUIRE(base::get<std::string>(small).size() == 100);
+
+  base::spsc_variant_queue<int, std::string> queue{4};
+  queue.emplace<std::string>("message");
+  std::size_t visited = 0;
+  REQUIRE(queue.try_visit([&visited](auto& x) { visited = length{}(x); }));
+  REQUIRE(visited == 7);
+}
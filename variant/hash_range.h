@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+#include "variant.h"
+
+namespace base {
+
+// Writes `std::hash<V>{}(*it)` of every variant in `[first, last)` to `out`
+// and returns iterator past the last written hash.
+//
+// When every alternative is an integer, enum or pointer type, each element is
+// hashed from the raw bytes of its storage without dispatching on the index,
+// so the loop has no data dependent branches at all. Otherwise every element
+// is hashed with a dispatch on its index.
+template <class InputIt, class OutputIt>
+OutputIt hash_range(InputIt first, InputIt last, OutputIt out) {
+  for (; first != last; ++first, ++out) {
+    *out = std::hash<std::decay_t<decltype(*first)>>{}(*first);
+  }
+  return out;
+}
+
+}  // namespace base
@@ -0,0 +1,87 @@
+#include "hash_range.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "never_empty_variant.h"
+#include "test_util.h"
+
+namespace {
+
+enum class color : std::uint8_t { red, green };
+
+}  // namespace
+
+namespace std {
+
+template <>
+struct hash<base::testing::throw_on_move> {
+  std::size_t operator()(const base::testing::throw_on_move&) const {
+    return 0;
+  }
+};
+
+}  // namespace std
+
+namespace {
+
+using base::testing::throw_on_move;
+
+template <class V>
+void check_hash_range(const std::vector<V>& values) {
+  std::vector<std::size_t> hashes(values.size());
+  REQUIRE(base::hash_range(values.begin(), values.end(), hashes.begin()) ==
+          hashes.end());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    REQUIRE(hashes[i] == std::hash<V>{}(values[i]));
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Hash range test", "[hash_range]") {
+  int x = 0;
+  using raw_t = base::variant<char, std::int64_t, color, int*, bool>;
+  check_hash_range(std::vector<raw_t>{'a', std::int64_t{-1}, color::green, &x,
+                                      true, std::int64_t{'a'}});
+
+  using string_t = base::variant<int, std::string>;
+  check_hash_range(std::vector<string_t>{1, std::string{"1"}, 2});
+
+  using never_empty_t = base::never_empty_variant<int, long>;
+  check_hash_range(std::vector<never_empty_t>{1, 1L});
+  REQUIRE(std::hash<never_empty_t>{}(1) ==
+          std::hash<base::variant<int, long>>{}(1));
+}
+
+TEST_CASE("Raw bytes hash test", "[hash_range]") {
+  using raw_t = base::variant<char, std::int64_t, color, int*, bool>;
+  const auto by_bytes = [](const raw_t& v) {
+    return base::detail::hash_variant(std::true_type{}, v);
+  };
+  const auto by_dispatch = [](const raw_t& v) {
+    return base::detail::hash_variant(std::false_type{}, v);
+  };
+
+  int x = 0;
+  for (const raw_t& v : {raw_t{'a'}, raw_t{std::int64_t{-12345678901}},
+                         raw_t{color::green}, raw_t{&x}, raw_t{false}}) {
+    REQUIRE(by_bytes(v) == by_dispatch(v));
+  }
+  // Garbage left in the storage by a larger alternative doesn't matter.
+  raw_t v = std::int64_t{-1};
+  v = 'a';
+  REQUIRE(by_bytes(v) == by_bytes(raw_t{'a'}));
+  REQUIRE(by_bytes(raw_t{'a'}) != by_bytes(raw_t{std::int64_t{'a'}}));
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  using valueless_t = base::variant<int, throw_on_move>;
+  std::vector<valueless_t> values(3);
+  REQUIRE_THROWS_AS(values[1].emplace<1>(throw_on_move{}), std::runtime_error);
+  check_hash_range(values);
+  REQUIRE(std::hash<valueless_t>{}(values[1]) !=
+          std::hash<valueless_t>{}(values[0]));
+#endif
+}
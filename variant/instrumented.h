@@ -0,0 +1,74 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+namespace base {
+
+namespace testing {
+
+// Numbers of special member calls.
+struct operation_counts {
+  int copies = 0;
+  int moves = 0;
+  int copy_assignments = 0;
+  int move_assignments = 0;
+  int destructions = 0;
+};
+
+// Wrapper around `T`, which counts copies, moves and destructions. Counters
+// are shared by all the objects of the same `instrumented` type, `reset()`
+// clears them. Copy constructor is noexcept if `nothrow_copy` is set, so
+// both ways of copy assignment of a variant can be tested with the same `T`.
+template <class T,
+          bool nothrow_copy = std::is_nothrow_copy_constructible<T>::value>
+class instrumented {
+ public:
+  template <class... Args,
+            class = std::enable_if_t<std::is_constructible<T, Args...>::value>>
+  instrumented(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+  instrumented(const instrumented& rhs) noexcept(nothrow_copy)
+      : value(rhs.value) {
+    ++counts().copies;
+  }
+
+  instrumented(instrumented&& rhs) noexcept : value(std::move(rhs.value)) {
+    ++counts().moves;
+  }
+
+  instrumented& operator=(const instrumented& rhs) {
+    value = rhs.value;
+    ++counts().copy_assignments;
+    return *this;
+  }
+
+  instrumented& operator=(instrumented&& rhs) noexcept {
+    value = std::move(rhs.value);
+    ++counts().move_assignments;
+    return *this;
+  }
+
+  ~instrumented() { ++counts().destructions; }
+
+  static operation_counts& counts() noexcept {
+    static operation_counts result;
+    return result;
+  }
+
+  static void reset() noexcept { counts() = operation_counts{}; }
+
+  friend bool operator==(const instrumented& a, const instrumented& b) {
+    return a.value == b.value;
+  }
+
+  friend bool operator!=(const instrumented& a, const instrumented& b) {
+    return a.value != b.value;
+  }
+
+  T value;
+};
+
+}  // namespace testing
+
+}  // namespace base
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace base {
+
+namespace detail {
+
+// Position of the first `tag` in `[tags + from, tags + size)` or `size`.
+template <class Tag>
+std::size_t find_tag(const Tag* tags, std::size_t from, std::size_t size,
+                     Tag tag) noexcept {
+  for (std::size_t i = from; i < size; ++i) {
+    if (tags[i] == tag) {
+      return i;
+    }
+  }
+  return size;
+}
+
+#if defined(__SSE2__)
+// One byte tags are compared 16 at a time.
+inline std::size_t find_tag(const std::uint8_t* tags, std::size_t from,
+                            std::size_t size, std::uint8_t tag) noexcept {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+  std::size_t i = from;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+    const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+    if (mask != 0) {
+      return i + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+  }
+  for (; i < size; ++i) {
+    if (tags[i] == tag) {
+      return i;
+    }
+  }
+  return size;
+}
+#endif
+
+// Number of `tag` in `[tags + from, tags + to)`.
+template <class Tag>
+std::size_t count_tag(const Tag* tags, std::size_t from, std::size_t to,
+                      Tag tag) noexcept {
+  std::size_t result = 0;
+  for (std::size_t i = from; i < to; ++i) {
+    result += tags[i] == tag;
+  }
+  return result;
+}
+
+#if defined(__SSE2__)
+inline std::size_t count_tag(const std::uint8_t* tags, std::size_t from,
+                             std::size_t to, std::uint8_t tag) noexcept {
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(tag));
+  std::size_t result = 0;
+  std::size_t i = from;
+  for (; i + 16 <= to; i += 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+    result += __builtin_popcount(static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))));
+  }
+  for (; i < to; ++i) {
+    result += tags[i] == tag;
+  }
+  return result;
+}
+#endif
+
+}  // namespace detail
+
+}  // namespace base
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "variant_traits.h"
+
+namespace base {
+
+namespace detail {
+
+// Alternatives, which are equal if and only if their bytes are equal, are
+// hashed as raw bytes. Floating point types are not among them: `0.0 == -0.0`.
+template <class T>
+constexpr bool is_bytewise_hashable =
+    (std::is_integral<T>::value || std::is_enum<T>::value ||
+     std::is_pointer<T>::value) &&
+    sizeof(T) <= sizeof(std::uint64_t);
+
+template <class T, class = void>
+struct is_hash_enabled : std::false_type {};
+
+template <class T>
+struct is_hash_enabled<T, base::void_t<decltype(std::hash<T>{}(
+                              std::declval<const T&>()))>>
+    : std::is_default_constructible<std::hash<T>> {};
+
+// Sizes of the alternatives by stored index, the first one is for the
+// valueless variant.
+template <class... Ts>
+struct bytewise_hash_sizes {
+  static constexpr std::size_t value[] = {0, sizeof(Ts)...};
+};
+
+template <class... Ts>
+constexpr std::size_t bytewise_hash_sizes<Ts...>::value[];
+
+template <class T>
+std::uint64_t raw_bits(const T& value) noexcept {
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(T));
+  return bits;
+}
+
+template <class T, bool = is_bytewise_hashable<T>>
+struct alternative_hash {
+  std::uint64_t operator()(const T& value) const {
+    return std::hash<T>{}(value);
+  }
+};
+
+template <class T>
+struct alternative_hash<T, true> {
+  std::uint64_t operator()(const T& value) const noexcept {
+    return raw_bits(value);
+  }
+};
+
+// Finalizer of MurmurHash3.
+constexpr std::uint64_t hash_mix(std::uint64_t h) noexcept {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Hash of the variant with `stored_index` (0 for valueless), holding an
+// alternative with hash `h`.
+constexpr std::size_t combine_variant_hash(std::size_t stored_index,
+                                           std::uint64_t h) noexcept {
+  return static_cast<std::size_t>(
+      hash_mix(h ^ (stored_index * 0x9e3779b97f4a7c15ULL)));
+}
+
+}  // namespace detail
+
+}  // namespace base
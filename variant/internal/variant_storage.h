@@ -0,0 +1,536 @@
+#pragma once
+
+#include <memory>
+#include <new>
+
+#include "variant_traits.h"
+
+namespace base {
+
+namespace detail {
+
+// Recursive union of all the alternatives. Unlike raw storage, it can be
+// initialized and read in constant expressions.
+template <bool trivially_destructible, class... Ts>
+union recursive_union {};
+
+template <class T, class... Ts>
+union recursive_union<true, T, Ts...> {
+  constexpr recursive_union() noexcept : valueless_{} {}
+
+  template <class... Args>
+  constexpr explicit recursive_union(in_place_index_t<0>, Args&&... args)
+      : head_(std::forward<Args>(args)...) {}
+
+  template <std::size_t I, class... Args>
+  constexpr explicit recursive_union(in_place_index_t<I>, Args&&... args)
+      : tail_(in_place_index<I - 1>, std::forward<Args>(args)...) {}
+
+  char valueless_;
+  T head_;
+  recursive_union<true, Ts...> tail_;
+};
+
+template <class T, class... Ts>
+union recursive_union<false, T, Ts...> {
+  constexpr recursive_union() noexcept : valueless_{} {}
+
+  template <class... Args>
+  constexpr explicit recursive_union(in_place_index_t<0>, Args&&... args)
+      : head_(std::forward<Args>(args)...) {}
+
+  template <std::size_t I, class... Args>
+  constexpr explicit recursive_union(in_place_index_t<I>, Args&&... args)
+      : tail_(in_place_index<I - 1>, std::forward<Args>(args)...) {}
+
+  // Active member is destroyed by the owning variant.
+  ~recursive_union() {}
+
+  char valueless_;
+  T head_;
+  recursive_union<false, Ts...> tail_;
+};
+
+template <std::size_t I>
+struct union_member {
+  template <class U>
+  static constexpr decltype(auto) get(U&& u) noexcept {
+    return union_member<I - 1>::get(std::forward<U>(u).tail_);
+  }
+};
+
+template <>
+struct union_member<0> {
+  template <class U>
+  static constexpr decltype(auto) get(U&& u) noexcept {
+    return (std::forward<U>(u).head_);
+  }
+};
+
+// Alternatives which carry no state at all: objects of such types are
+// indistinguishable, so the variant doesn't need to store them.
+template <class T>
+constexpr bool is_stateless =
+    std::is_empty<T>::value &&
+    std::is_trivially_default_constructible<T>::value &&
+    std::is_trivially_destructible<T>::value;
+
+template <class T>
+struct shared_instance {
+  static T value;
+};
+
+template <class T>
+T shared_instance<T>::value;
+
+// Tag of the constructor leaving variant storage valueless.
+struct valueless_construct_t {};
+
+// Holds the active alternative in the recursive union.
+template <bool all_stateless, class... Ts>
+struct alternatives_storage {
+  template <std::size_t I>
+  using alternative_t = base::type_pack_element_t<I, Ts...>;
+
+  alternatives_storage() = default;
+
+  template <std::size_t I, class... Args>
+  constexpr explicit alternatives_storage(in_place_index_t<I>, Args&&... args)
+      : storage_(in_place_index<I>, std::forward<Args>(args)...) {}
+
+  template <std::size_t I>
+  constexpr alternative_t<I>& alternative() noexcept {
+    return union_member<I>::get(storage_);
+  }
+
+  template <std::size_t I>
+  constexpr const alternative_t<I>& alternative() const noexcept {
+    return union_member<I>::get(storage_);
+  }
+
+  template <std::size_t I, class... Args>
+  void construct(Args&&... args) {
+    ::new (static_cast<void*>(std::addressof(alternative<I>())))
+        alternative_t<I>(std::forward<Args>(args)...);
+  }
+
+  // Address of the active alternative, whichever it is.
+  const void* data() const noexcept { return std::addressof(storage_); }
+
+  recursive_union<base::conjunction_v<std::is_trivially_destructible<Ts>...>,
+                  Ts...>
+      storage_;
+};
+
+// All the alternatives are stateless, so nothing is stored: the variant is
+// just its index, and accessors refer to the instance shared by all variants.
+// Alternatives are still constructed, so constructors with side effects run.
+template <class... Ts>
+struct alternatives_storage<true, Ts...> {
+  template <std::size_t I>
+  using alternative_t = base::type_pack_element_t<I, Ts...>;
+
+  alternatives_storage() = default;
+
+  template <std::size_t I, class... Args>
+  constexpr explicit alternatives_storage(in_place_index_t<I>,
+                                          Args&&... args) {
+    (void)alternative_t<I>(std::forward<Args>(args)...);
+  }
+
+  template <std::size_t I>
+  constexpr alternative_t<I>& alternative() const noexcept {
+    return shared_instance<alternative_t<I>>::value;
+  }
+
+  template <std::size_t I, class... Args>
+  void construct(Args&&... args) {
+    (void)alternative_t<I>(std::forward<Args>(args)...);
+  }
+};
+
+template <class... Ts>
+using alternatives_storage_t =
+    alternatives_storage<base::conjunction_v<
+                             std::integral_constant<bool, is_stateless<Ts>>...>,
+                         Ts...>;
+
+// Storage of the variant together with all the operations on it, which do not
+// depend on the triviality of alternatives.
+//
+// Alternatives storage is a base, so it takes no space when it's empty.
+template <class... Ts>
+struct variant_storage : alternatives_storage_t<Ts...> {
+  template <std::size_t I>
+  using alternative_t = base::type_pack_element_t<I, Ts...>;
+
+  variant_storage() = default;
+
+  // Valueless storage for the copy and move constructors, which unlike
+  // value-initialization doesn't zero the alternatives first.
+  explicit variant_storage(valueless_construct_t) noexcept {}
+
+  template <std::size_t I, class... Args>
+  constexpr explicit variant_storage(in_place_index_t<I>, Args&&... args)
+      : alternatives_storage_t<Ts...>(in_place_index<I>,
+                                      std::forward<Args>(args)...),
+        index_(I + 1) {}
+
+  constexpr bool is_valueless() const noexcept {
+    return index_ == valueless_stored_index;
+  }
+
+  using alternatives_storage_t<Ts...>::alternative;
+
+  // Requires variant to be valueless.
+  template <std::size_t I, class... Args>
+  alternative_t<I>& emplace_alternative(Args&&... args) {
+    this->template construct<I>(std::forward<Args>(args)...);
+    index_ = I + 1;
+    return this->template alternative<I>();
+  }
+
+  void destroy() noexcept {
+    if (!base::conjunction_v<std::is_trivially_destructible<Ts>...> &&
+        !is_valueless()) {
+      dispatch_index<void, sizeof...(Ts)>(index_ - 1, [this](auto i) {
+        using T = alternative_t<decltype(i)::value>;
+        this->template alternative<decltype(i)::value>().~T();
+      });
+    }
+  }
+
+  void reset() noexcept {
+    destroy();
+    index_ = valueless_stored_index;
+  }
+
+  // Destroys the held alternative and constructs alternative `I` in its place.
+  // Variant is left valueless if the construction throws.
+  template <std::size_t I, class... Args>
+  alternative_t<I>& replace(Args&&... args) {
+    destroy();
+    BASE_VARIANT_TRY {
+      return emplace_alternative<I>(std::forward<Args>(args)...);
+    } BASE_VARIANT_CATCH_ALL {
+      index_ = valueless_stored_index;
+      BASE_VARIANT_RETHROW;
+    }
+  }
+
+  // Replaces the held alternative with a copy of `value`. The copy is made in
+  // place, unless it may throw while moving can't: then it's made aside and
+  // moved in, so a failed copy leaves the variant untouched.
+  template <std::size_t I>
+  void replace_with_copy(const alternative_t<I>& value) {
+    using T = alternative_t<I>;
+    replace_with_copy<I>(
+        std::integral_constant<
+            bool, std::is_nothrow_copy_constructible<T>::value ||
+                      !std::is_nothrow_move_constructible<T>::value>{},
+        value);
+  }
+
+  // Requires variant to be valueless.
+  void construct_from(const variant_storage& rhs) {
+    if (!rhs.is_valueless()) {
+      dispatch_index<void, sizeof...(Ts)>(rhs.index_ - 1, [&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        emplace_alternative<I>(rhs.template alternative<I>());
+      });
+    }
+  }
+
+  // Requires variant to be valueless.
+  void construct_from(variant_storage&& rhs) {
+    if (!rhs.is_valueless()) {
+      dispatch_index<void, sizeof...(Ts)>(rhs.index_ - 1, [&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        emplace_alternative<I>(std::move(rhs.template alternative<I>()));
+      });
+    }
+  }
+
+  void assign_from(variant_storage&& rhs) {
+    if (rhs.is_valueless()) {
+      reset();
+    } else if (index_ == rhs.index_) {
+      dispatch_index<void, sizeof...(Ts)>(index_ - 1, [&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        this->template alternative<I>() =
+            std::move(rhs.template alternative<I>());
+      });
+    } else {
+      dispatch_index<void, sizeof...(Ts)>(rhs.index_ - 1, [&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        replace<I>(std::move(rhs.template alternative<I>()));
+      });
+    }
+  }
+
+  void assign_from(const variant_storage& rhs) {
+    if (rhs.is_valueless()) {
+      reset();
+    } else if (index_ == rhs.index_) {
+      dispatch_index<void, sizeof...(Ts)>(index_ - 1, [&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        this->template alternative<I>() = rhs.template alternative<I>();
+      });
+    } else {
+      dispatch_index<void, sizeof...(Ts)>(rhs.index_ - 1, [&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        replace_with_copy<I>(rhs.template alternative<I>());
+      });
+    }
+  }
+
+  void swap(variant_storage& rhs) {
+    if (index_ == rhs.index_) {
+      if (!is_valueless()) {
+        dispatch_index<void, sizeof...(Ts)>(index_ - 1, [&](auto i) {
+          constexpr std::size_t I = decltype(i)::value;
+          using std::swap;
+          swap(this->template alternative<I>(), rhs.template alternative<I>());
+        });
+      }
+    } else if (is_valueless()) {
+      construct_from(std::move(rhs));
+      rhs.reset();
+    } else if (rhs.is_valueless()) {
+      rhs.construct_from(std::move(*this));
+      reset();
+    } else {
+      // Three moves: `rhs` alternative is put aside, ours is moved into `rhs`
+      // and the one aside is moved into us.
+      dispatch_index<void, sizeof...(Ts)>(rhs.index_ - 1, [&](auto j) {
+        constexpr std::size_t J = decltype(j)::value;
+        alternative_t<J> aside(std::move(rhs.template alternative<J>()));
+        rhs.reset();
+        rhs.construct_from(std::move(*this));
+        replace<J>(std::move(aside));
+      });
+    }
+  }
+
+  template <std::size_t I>
+  void replace_with_copy(std::true_type, const alternative_t<I>& value) {
+    replace<I>(value);
+  }
+
+  template <std::size_t I>
+  void replace_with_copy(std::false_type, const alternative_t<I>& value) {
+    alternative_t<I> copy(value);
+    replace<I>(std::move(copy));
+  }
+
+  // Storage goes first, so the narrow index lands in what would otherwise be
+  // tail padding of the whole object.
+  index_type_t<sizeof...(Ts)> index_ = valueless_stored_index;
+};
+
+// Each layer below adds one special member function on top of the previous
+// one. Layer is either trivial (defaulted), implemented via `variant_storage`
+// operations or deleted, depending on the corresponding properties of the
+// alternatives. This way variant of trivial types is trivial itself.
+enum class special_member { trivial, provided, deleted };
+
+template <bool all_trivial, bool all_available>
+constexpr special_member special_member_kind =
+    all_trivial ? special_member::trivial
+                : (all_available ? special_member::provided
+                                 : special_member::deleted);
+
+template <bool trivially_destructible, class... Ts>
+struct variant_destructor : variant_storage<Ts...> {
+  using variant_storage<Ts...>::variant_storage;
+};
+
+template <class... Ts>
+struct variant_destructor<false, Ts...> : variant_storage<Ts...> {
+  using variant_storage<Ts...>::variant_storage;
+
+  variant_destructor() = default;
+  variant_destructor(const variant_destructor&) = default;
+  variant_destructor(variant_destructor&&) = default;
+  variant_destructor& operator=(const variant_destructor&) = default;
+  variant_destructor& operator=(variant_destructor&&) = default;
+
+  ~variant_destructor() { this->destroy(); }
+};
+
+template <class... Ts>
+using variant_destructor_t = variant_destructor<
+    base::conjunction_v<std::is_trivially_destructible<Ts>...>, Ts...>;
+
+template <special_member, class... Ts>
+struct variant_move_ctor : variant_destructor_t<Ts...> {
+  using variant_destructor_t<Ts...>::variant_destructor_t;
+};
+
+template <class... Ts>
+struct variant_move_ctor<special_member::provided, Ts...>
+    : variant_destructor_t<Ts...> {
+  using variant_destructor_t<Ts...>::variant_destructor_t;
+
+  variant_move_ctor() = default;
+  variant_move_ctor(const variant_move_ctor&) = default;
+  variant_move_ctor(variant_move_ctor&& rhs) noexcept(
+      base::conjunction_v<std::is_nothrow_move_constructible<Ts>...>)
+      : variant_destructor_t<Ts...>(valueless_construct_t{}) {
+    this->construct_from(std::move(rhs));
+  }
+  variant_move_ctor& operator=(const variant_move_ctor&) = default;
+  variant_move_ctor& operator=(variant_move_ctor&&) = default;
+};
+
+template <class... Ts>
+struct variant_move_ctor<special_member::deleted, Ts...>
+    : variant_destructor_t<Ts...> {
+  using variant_destructor_t<Ts...>::variant_destructor_t;
+
+  variant_move_ctor() = default;
+  variant_move_ctor(const variant_move_ctor&) = default;
+  variant_move_ctor(variant_move_ctor&&) = delete;
+  variant_move_ctor& operator=(const variant_move_ctor&) = default;
+  variant_move_ctor& operator=(variant_move_ctor&&) = default;
+};
+
+template <class... Ts>
+using variant_move_ctor_t = variant_move_ctor<
+    special_member_kind<
+        base::conjunction_v<std::is_trivially_move_constructible<Ts>...>,
+        base::conjunction_v<std::is_move_constructible<Ts>...>>,
+    Ts...>;
+
+template <special_member, class... Ts>
+struct variant_copy_ctor : variant_move_ctor_t<Ts...> {
+  using variant_move_ctor_t<Ts...>::variant_move_ctor_t;
+};
+
+template <class... Ts>
+struct variant_copy_ctor<special_member::provided, Ts...>
+    : variant_move_ctor_t<Ts...> {
+  using variant_move_ctor_t<Ts...>::variant_move_ctor_t;
+
+  variant_copy_ctor() = default;
+  variant_copy_ctor(const variant_copy_ctor& rhs)
+      : variant_move_ctor_t<Ts...>(valueless_construct_t{}) {
+    this->construct_from(rhs);
+  }
+  variant_copy_ctor(variant_copy_ctor&&) = default;
+  variant_copy_ctor& operator=(const variant_copy_ctor&) = default;
+  variant_copy_ctor& operator=(variant_copy_ctor&&) = default;
+};
+
+template <class... Ts>
+struct variant_copy_ctor<special_member::deleted, Ts...>
+    : variant_move_ctor_t<Ts...> {
+  using variant_move_ctor_t<Ts...>::variant_move_ctor_t;
+
+  variant_copy_ctor() = default;
+  variant_copy_ctor(const variant_copy_ctor&) = delete;
+  variant_copy_ctor(variant_copy_ctor&&) = default;
+  variant_copy_ctor& operator=(const variant_copy_ctor&) = default;
+  variant_copy_ctor& operator=(variant_copy_ctor&&) = default;
+};
+
+template <class... Ts>
+using variant_copy_ctor_t = variant_copy_ctor<
+    special_member_kind<
+        base::conjunction_v<std::is_trivially_copy_constructible<Ts>...>,
+        base::conjunction_v<std::is_copy_constructible<Ts>...>>,
+    Ts...>;
+
+template <special_member, class... Ts>
+struct variant_move_assign : variant_copy_ctor_t<Ts...> {
+  using variant_copy_ctor_t<Ts...>::variant_copy_ctor_t;
+};
+
+template <class... Ts>
+struct variant_move_assign<special_member::provided, Ts...>
+    : variant_copy_ctor_t<Ts...> {
+  using variant_copy_ctor_t<Ts...>::variant_copy_ctor_t;
+
+  variant_move_assign() = default;
+  variant_move_assign(const variant_move_assign&) = default;
+  variant_move_assign(variant_move_assign&&) = default;
+  variant_move_assign& operator=(const variant_move_assign&) = default;
+  variant_move_assign& operator=(variant_move_assign&& rhs) noexcept(
+      base::conjunction_v<std::is_nothrow_move_constructible<Ts>...,
+                          std::is_nothrow_move_assignable<Ts>...>) {
+    this->assign_from(std::move(rhs));
+    return *this;
+  }
+};
+
+template <class... Ts>
+struct variant_move_assign<special_member::deleted, Ts...>
+    : variant_copy_ctor_t<Ts...> {
+  using variant_copy_ctor_t<Ts...>::variant_copy_ctor_t;
+
+  variant_move_assign() = default;
+  variant_move_assign(const variant_move_assign&) = default;
+  variant_move_assign(variant_move_assign&&) = default;
+  variant_move_assign& operator=(const variant_move_assign&) = default;
+  variant_move_assign& operator=(variant_move_assign&&) = delete;
+};
+
+template <class... Ts>
+using variant_move_assign_t = variant_move_assign<
+    special_member_kind<
+        base::conjunction_v<std::is_trivially_move_constructible<Ts>...,
+                            std::is_trivially_move_assignable<Ts>...,
+                            std::is_trivially_destructible<Ts>...>,
+        base::conjunction_v<std::is_move_constructible<Ts>...,
+                            std::is_move_assignable<Ts>...>>,
+    Ts...>;
+
+template <special_member, class... Ts>
+struct variant_copy_assign : variant_move_assign_t<Ts...> {
+  using variant_move_assign_t<Ts...>::variant_move_assign_t;
+};
+
+template <class... Ts>
+struct variant_copy_assign<special_member::provided, Ts...>
+    : variant_move_assign_t<Ts...> {
+  using variant_move_assign_t<Ts...>::variant_move_assign_t;
+
+  variant_copy_assign() = default;
+  variant_copy_assign(const variant_copy_assign&) = default;
+  variant_copy_assign(variant_copy_assign&&) = default;
+  variant_copy_assign& operator=(const variant_copy_assign& rhs) {
+    this->assign_from(rhs);
+    return *this;
+  }
+  variant_copy_assign& operator=(variant_copy_assign&&) = default;
+};
+
+template <class... Ts>
+struct variant_copy_assign<special_member::deleted, Ts...>
+    : variant_move_assign_t<Ts...> {
+  using variant_move_assign_t<Ts...>::variant_move_assign_t;
+
+  variant_copy_assign() = default;
+  variant_copy_assign(const variant_copy_assign&) = default;
+  variant_copy_assign(variant_copy_assign&&) = default;
+  variant_copy_assign& operator=(const variant_copy_assign&) = delete;
+  variant_copy_assign& operator=(variant_copy_assign&&) = default;
+};
+
+template <class... Ts>
+using variant_copy_assign_t = variant_copy_assign<
+    special_member_kind<
+        base::conjunction_v<std::is_trivially_copy_constructible<Ts>...,
+                            std::is_trivially_copy_assignable<Ts>...,
+                            std::is_trivially_destructible<Ts>...>,
+        base::conjunction_v<std::is_copy_constructible<Ts>...,
+                            std::is_copy_assignable<Ts>...>>,
+    Ts...>;
+
+// The topmost layer, variant itself is derived from it.
+template <class... Ts>
+using variant_base_t = variant_copy_assign_t<Ts...>;
+
+}  // namespace detail
+
+}  // namespace base
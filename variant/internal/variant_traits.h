@@ -1,36 +1,258 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <exception>
+#include <tuple>
 
 #include "matrix_ops.h"
 
+// Maximum number of alternatives (plus one for the valueless state), for which
+// single variant dispatch is done by `switch` instead of function pointers
+// table. Table calls can't be inlined, while `switch` lets the compiler inline
+// and constant-propagate the visitor.
+#ifndef BASE_VARIANT_MAX_SWITCH_CASES
+#define BASE_VARIANT_MAX_SWITCH_CASES 16
+#endif
+
+// Visitation of several variants either builds one table over all the
+// combinations of alternatives (default), or dispatches variants one by one
+// (when set to 1). The latter doesn't build matrix of indexes and lets each
+// level use `switch` dispatch.
+#ifndef BASE_VARIANT_NESTED_MULTI_VISIT
+#define BASE_VARIANT_NESTED_MULTI_VISIT 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BASE_VARIANT_UNREACHABLE() __builtin_unreachable()
+#define BASE_VARIANT_COLD __attribute__((noinline, cold))
+#define BASE_VARIANT_LIKELY(x) __builtin_expect(!!(x), 1)
+#else
+#define BASE_VARIANT_UNREACHABLE() std::terminate()
+#define BASE_VARIANT_COLD
+#define BASE_VARIANT_LIKELY(x) (x)
+#endif
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define BASE_VARIANT_HAS_EXCEPTIONS 1
+#else
+#define BASE_VARIANT_HAS_EXCEPTIONS 0
+#endif
+
+// Errors of the library (`bad_variant_access`, full `variant_vector` pool)
+// are reported to the fatal error handler instead of being thrown (when set
+// to 1). Defaults to 1 when the code is compiled without exceptions.
+#ifndef BASE_VARIANT_NO_EXCEPTIONS
+#define BASE_VARIANT_NO_EXCEPTIONS (!BASE_VARIANT_HAS_EXCEPTIONS)
+#endif
+
+#if !BASE_VARIANT_NO_EXCEPTIONS && !BASE_VARIANT_HAS_EXCEPTIONS
+#error "BASE_VARIANT_NO_EXCEPTIONS must be 1 when exceptions are disabled."
+#endif
+
+// Cleanup of a throwing alternative's constructor. Without exceptions the
+// handler is compiled, but never runs.
+#if BASE_VARIANT_HAS_EXCEPTIONS
+#define BASE_VARIANT_TRY try
+#define BASE_VARIANT_CATCH_ALL catch (...)
+#define BASE_VARIANT_RETHROW throw
+#else
+#define BASE_VARIANT_TRY if (true)
+#define BASE_VARIANT_CATCH_ALL else
+#define BASE_VARIANT_RETHROW BASE_VARIANT_UNREACHABLE()
+#endif
+
 namespace base {
 
 template <class... Ts>
 class variant;
 
-class bad_variant_access : public std::exception {};
+template <class... Ts>
+class never_empty_variant;
+
+class bad_variant_access : public std::exception {
+ public:
+  const char* what() const noexcept override { return "bad_variant_access"; }
+};
+
+// Called with the description of a library error when exceptions are off.
+// Must not return: the program is aborted if it does.
+using variant_error_handler = void (*)(const char* message);
 
 namespace detail {
 
+inline void default_variant_error_handler(const char* message) {
+  std::fprintf(stderr, "%s\n", message);
+}
+
+inline std::atomic<variant_error_handler>&
+variant_error_handler_ref() noexcept {
+  static std::atomic<variant_error_handler> handler{
+      &default_variant_error_handler};
+  return handler;
+}
+
+}  // namespace detail
+
+// Replaces the fatal error handler (null restores the default one, which
+// prints the message), returns the previous one.
+inline variant_error_handler set_variant_error_handler(
+    variant_error_handler handler) noexcept {
+  return detail::variant_error_handler_ref().exchange(
+      handler != nullptr ? handler : &detail::default_variant_error_handler);
+}
+
+namespace detail {
+
+// Throws `E{args...}` or, in the no-exceptions mode, passes it to the fatal
+// error handler. Kept out of line and constructs the error itself, so the
+// callers only have a call rather than the throw and its cleanup.
+template <class E, class... Args>
+[[noreturn]] BASE_VARIANT_COLD void raise(const Args&... args) {
+#if BASE_VARIANT_NO_EXCEPTIONS
+  variant_error_handler_ref().load()(E{args...}.what());
+  std::abort();
+#else
+  throw E{args...};
+#endif
+}
+
+}  // namespace detail
+
+template <class T>
+struct in_place_type_t {};
+
+template <class T>
+constexpr in_place_type_t<T> in_place_type;
+
+template <std::size_t I>
+struct in_place_index_t {};
+
+template <std::size_t I>
+constexpr in_place_index_t<I> in_place_index;
+
+namespace detail {
+
+// Alternatives may be stored boxed (see `out_of_line`), in which case the box
+// specializes this trait. Everything except the storage itself sees the boxed
+// value rather than the box.
+template <class T>
+struct unboxed {
+  using type = T;
+
+  static constexpr T& get(T& value) noexcept { return value; }
+  static constexpr const T& get(const T& value) noexcept { return value; }
+};
+
+template <class T>
+using unboxed_t = typename unboxed<T>::type;
+
+template <class T>
+constexpr decltype(auto) unbox(T& value) noexcept {
+  return unboxed<std::remove_const_t<T>>::get(value);
+}
+
+template <bool in_range, std::size_t I, class... Ts>
+struct alternative_type_impl {};
+
+template <std::size_t I, class... Ts>
+struct alternative_type_impl<true, I, Ts...> {
+  using type = unboxed_t<base::type_pack_element_t<I, Ts...>>;
+};
+
+// Type of alternative `I` as seen by the users of `variant<Ts...>`. Has no
+// `type` member when `I` is out of range.
+template <std::size_t I, class... Ts>
+struct alternative_type
+    : alternative_type_impl<(I < sizeof...(Ts)), I, Ts...> {};
+
+template <std::size_t I, class... Ts>
+using alternative_type_t = typename alternative_type<I, Ts...>::type;
+
+template <class... Ts>
+std::true_type is_never_empty_test(const never_empty_variant<Ts...>*);
+std::false_type is_never_empty_test(const void*);
+
+// Whether `V` is `never_empty_variant` or derived from it. Visitation of such
+// variants doesn't reserve a row in handlers tables for the valueless state.
+template <class V>
+struct is_never_empty : decltype(is_never_empty_test(std::declval<V*>())) {};
+
 struct variant_accessor {
   template <std::size_t I, class... Ts>
-  static base::type_pack_element_t<I, Ts...>& get(variant<Ts...>& v);
+  static constexpr alternative_type_t<I, Ts...>& get(
+      variant<Ts...>& v);
 
   template <std::size_t I, class... Ts>
-  static const base::type_pack_element_t<I, Ts...>& get(
+  static constexpr const alternative_type_t<I, Ts...>& get(
       const variant<Ts...>& v);
 
   template <std::size_t I, class... Ts>
-  static base::type_pack_element_t<I, Ts...>&& get(variant<Ts...>&& v);
+  static constexpr alternative_type_t<I, Ts...>&& get(
+      variant<Ts...>&& v);
 
   template <std::size_t I, class... Ts>
-  static const base::type_pack_element_t<I, Ts...>&& get(
+  static constexpr const alternative_type_t<I, Ts...>&& get(
       const variant<Ts...>&& v);
+
+  template <class... Ts>
+  static const void* data(const variant<Ts...>& v) noexcept;
+
+  // `never_empty_variant` hides its `variant` base from the users, so none of
+  // the `variant` modifiers can make it valueless, but not from the library.
+  template <std::size_t I, class V,
+            class = std::enable_if_t<is_never_empty<std::decay_t<V>>::value>>
+  static constexpr decltype(auto) get(V&& v) {
+    return get<I>(as_variant(std::forward<V>(v)));
+  }
+
+  template <class... Ts>
+  static constexpr variant<Ts...>& as_variant(
+      never_empty_variant<Ts...>& v) noexcept {
+    return v;
+  }
+
+  template <class... Ts>
+  static constexpr const variant<Ts...>& as_variant(
+      const never_empty_variant<Ts...>& v) noexcept {
+    return v;
+  }
+
+  template <class... Ts>
+  static constexpr variant<Ts...>&& as_variant(
+      never_empty_variant<Ts...>&& v) noexcept {
+    return std::move(v);
+  }
+
+  template <class... Ts>
+  static constexpr const variant<Ts...>&& as_variant(
+      const never_empty_variant<Ts...>&& v) noexcept {
+    return std::move(v);
+  }
 };
 
 constexpr std::size_t variant_npos = -1;
 
+// Smallest unsigned integer type able to hold every value in `[0, n]`.
+template <std::size_t n>
+using index_type_t = std::conditional_t<
+    n <= UINT8_MAX, std::uint8_t,
+    std::conditional_t<n <= UINT16_MAX, std::uint16_t,
+                       std::conditional_t<n <= UINT32_MAX, std::uint32_t,
+                                          std::size_t>>>;
+
+static_assert(std::is_same<index_type_t<1>, std::uint8_t>::value, "");
+static_assert(std::is_same<index_type_t<255>, std::uint8_t>::value, "");
+static_assert(std::is_same<index_type_t<256>, std::uint16_t>::value, "");
+static_assert(std::is_same<index_type_t<65536>, std::uint32_t>::value, "");
+
+// Variants store `index() + 1` in `index_type_t<sizeof...(Ts)>`, so
+// `variant_npos` maps onto zero and `(std::size_t)stored - 1` restores the
+// public index without any branches.
+constexpr std::size_t valueless_stored_index = 0;
+
 template <class T, class... Ts>
 constexpr std::size_t index_of_impl() {
   bool bs[] = {std::is_same<T, Ts>::value...};
@@ -56,6 +278,11 @@ static_assert(index_of<int, double> == variant_npos, "");
 static_assert(index_of<int, int, double, int> == variant_npos, "");
 static_assert(index_of<int> == variant_npos, "");
 
+// Position of `T` among the alternatives of `variant<Ts...>`, boxed
+// alternatives are looked up by the boxed type.
+template <class T, class... Ts>
+constexpr std::size_t alternative_index = index_of<T, unboxed_t<Ts>...>;
+
 template <class F, class Indexes, class... Vs>
 struct visit_concrete_result;
 
@@ -106,21 +333,72 @@ struct visit_result_impl<F, base::type_pack<IndexPacks...>, Vs...>
           base::conjunction_v<is_visitable_concrete<F, IndexPacks, Vs...>...>,
           base::type_pack<IndexPacks...>, Vs...> {};
 
+template <class... Ts>
+base::type_pack<Ts...> variant_alternatives_test(const variant<Ts...>*);
+template <class... Ts>
+base::type_pack<Ts...> variant_alternatives_test(
+    const never_empty_variant<Ts...>*);
+void variant_alternatives_test(const void*);
+
+// Alternatives of `V` as a `type_pack` if `V` is `variant` or derived from it,
+// otherwise `void`.
+template <class V>
+using variant_alternatives_t =
+    decltype(variant_alternatives_test(std::declval<V*>()));
+
+// Number of alternatives of variant `V` (or of a class derived from it).
+template <class V>
+constexpr std::size_t alternatives_count =
+    base::template_parameters_count_v<variant_alternatives_t<V>>;
+
+// Whether `V` is `variant` or derived from it.
+template <class V>
+using is_variant = std::integral_constant<
+    bool, !std::is_void<variant_alternatives_t<V>>::value>;
+
+template <class F, bool all_variants, class... Vs>
+struct visit_result_if_variants {};
+
 template <class F, class... Vs>
-struct visit_result
+struct visit_result_if_variants<F, true, Vs...>
     : visit_result_impl<
           F,
           decltype(matops::build_all_matrix_indexes(
-              std::index_sequence<
-                  base::template_parameters_count_v<std::decay_t<Vs>>...>{})),
+              std::index_sequence<alternatives_count<std::decay_t<Vs>>...>{})),
           Vs...> {};
 
+// Has no `type` member unless all `Vs` are variants, so other variant-like
+// types may provide their own `visit` overloads.
+template <class F, class... Vs>
+struct visit_result
+    : visit_result_if_variants<
+          F, base::conjunction_v<is_variant<std::decay_t<Vs>>...>, Vs...> {};
+
 template <class F, class... Vs>
 using visit_result_t = base::subtype<visit_result<F, Vs...>>;
 
+// Calls `f(args...)` and implicitly converts the result to `R`. When `R` is
+// void, the result is discarded.
+template <class R, bool is_void = std::is_void<R>::value>
+struct invoke_r {
+  template <class FRef, class... Args>
+  static constexpr R call(FRef&& f, Args&&... args) {
+    return std::forward<FRef>(f)(std::forward<Args>(args)...);
+  }
+};
+
+template <class R>
+struct invoke_r<R, true> {
+  template <class FRef, class... Args>
+  static constexpr R call(FRef&& f, Args&&... args) {
+    std::forward<FRef>(f)(std::forward<Args>(args)...);
+  }
+};
+
 template <class R, class FRef, class... VRefs, std::size_t... ids>
-R unwrap_indexes(FRef f, VRefs... vs, std::index_sequence<ids...>) {
-  return std::forward<FRef>(f)(
+constexpr R unwrap_indexes(FRef f, VRefs... vs, std::index_sequence<ids...>) {
+  return invoke_r<R>::call(
+      std::forward<FRef>(f),
       variant_accessor::get<ids - 1>(std::forward<VRefs>(vs))...);
 }
 
@@ -134,7 +412,7 @@ constexpr std::enable_if_t<!valueless, R> visit_concrete(FRef f, VRefs... vs) {
 // Valueless case (when some of variants is valueless by exception).
 template <class R, class Indexes, bool valueless, class FRef, class... VRefs>
 constexpr std::enable_if_t<valueless, R> visit_concrete(FRef, VRefs...) {
-  throw bad_variant_access{};
+  raise<bad_variant_access>();
 }
 
 // (size_t)(-1) + 1 == 0, so if one of indexes is 0, variant is valueless.
@@ -149,31 +427,269 @@ constexpr bool check_valueless(std::index_sequence<ids...>) {
   return false;
 }
 
-template <class R, class F, class... Vs, class... IndexPacks>
-R visit(F&& f, base::type_pack<IndexPacks...>, Vs&&... vs) {
-  using handler_type = R (*)(F&&, Vs && ...);
+template <class V>
+constexpr std::size_t visit_offset = is_never_empty<V>::value ? 1 : 0;
+
+// Number of handlers rows reserved for variant `V` in visitation matrix.
+template <class V>
+constexpr std::size_t visit_dimension =
+    alternatives_count<V> + 1 - visit_offset<V>;
+
+// Row `id` of the matrix corresponds to `index() + 1 == id + offset`.
+template <class Indexes, class Offsets>
+struct shift_indexes;
+
+template <std::size_t... ids, std::size_t... offsets>
+struct shift_indexes<std::index_sequence<ids...>,
+                     std::index_sequence<offsets...>> {
+  using type = std::index_sequence<(ids + offsets)...>;
+};
+
+template <class Indexes, class... Vs>
+using visit_indexes_t = base::subtype<shift_indexes<
+    Indexes, std::index_sequence<visit_offset<std::decay_t<Vs>>...>>>;
+
+// Tables of handlers are static data members rather than function local
+// statics, so they can be used in constant expressions.
+template <class R, class F, class IndexPacks, class... Vs>
+struct visit_handlers;
+
+template <class R, class F, class... IndexPacks, class... Vs>
+struct visit_handlers<R, F, base::type_pack<IndexPacks...>, Vs...> {
+  using handler_type = R (*)(F&&, Vs&&...);
+
+  static constexpr handler_type value[] = {
+      visit_concrete<R, visit_indexes_t<IndexPacks, Vs...>,
+                     check_valueless(visit_indexes_t<IndexPacks, Vs...>{}),
+                     F&&, Vs&&...>...};
+};
+
+template <class R, class F, class... IndexPacks, class... Vs>
+constexpr typename visit_handlers<R, F, base::type_pack<IndexPacks...>,
+                                  Vs...>::handler_type
+    visit_handlers<R, F, base::type_pack<IndexPacks...>, Vs...>::value[];
+
+// Dispatches through one table over the whole matrix of alternatives
+// combinations.
+template <class R, class F, class... Vs, class IndexPacks>
+constexpr R visit_matrix(F&& f, IndexPacks, Vs&&... vs) {
+  using FakeSizes =
+      std::index_sequence<visit_dimension<std::decay_t<Vs>>...>;
+
+  const std::size_t idx = matops::normal_to_flat_index(
+      FakeSizes{}, (vs.index() + 1 - visit_offset<std::decay_t<Vs>>)...);
+
+  return visit_handlers<R, F, IndexPacks, Vs...>::value[idx](
+      std::forward<F>(f), std::forward<Vs>(vs)...);
+}
+
+template <class R, class H, std::size_t I>
+constexpr R dispatch_index_case(H&& h) {
+  return std::forward<H>(h)(std::integral_constant<std::size_t, I>{});
+}
+
+template <class R, class H, class Indexes>
+struct dispatch_index_handlers;
+
+template <class R, class H, std::size_t... Is>
+struct dispatch_index_handlers<R, H, std::index_sequence<Is...>> {
+  using handler_type = R (*)(H&&);
+
+  static constexpr handler_type value[] = {dispatch_index_case<R, H, Is>...};
+};
+
+template <class R, class H, std::size_t... Is>
+constexpr typename dispatch_index_handlers<
+    R, H, std::index_sequence<Is...>>::handler_type
+    dispatch_index_handlers<R, H, std::index_sequence<Is...>>::value[];
+
+// Fallback for the large number of cases: indirect call through the table.
+template <class R, std::size_t n, class H>
+constexpr R dispatch_index_impl(std::false_type, std::size_t i, H&& h) {
+  return dispatch_index_handlers<R, H, std::make_index_sequence<n>>::value[i](
+      std::forward<H>(h));
+}
+
+template <class R, std::size_t I, bool in_range>
+struct switch_case {
+  template <class H>
+  static constexpr R call(H&& h) {
+    return std::forward<H>(h)(std::integral_constant<std::size_t, I>{});
+  }
+};
+
+template <class R, std::size_t I>
+struct switch_case<R, I, false> {
+  template <class H>
+  static constexpr R call(H&&) {
+    BASE_VARIANT_UNREACHABLE();
+  }
+};
+
+// Small number of cases: plain `switch`, so handlers can be inlined into the
+// caller.
+template <class R, std::size_t n, class H>
+constexpr R dispatch_index_impl(std::true_type, std::size_t i, H&& h) {
+#define BASE_VARIANT_SWITCH_CASE(I) \
+  case I:                           \
+    return switch_case<R, I, (I < n)>::call(std::forward<H>(h))
+#define BASE_VARIANT_SWITCH_CASES_4(I) \
+  BASE_VARIANT_SWITCH_CASE(I);         \
+  BASE_VARIANT_SWITCH_CASE(I + 1);     \
+  BASE_VARIANT_SWITCH_CASE(I + 2);     \
+  BASE_VARIANT_SWITCH_CASE(I + 3)
+
+  switch (i) {
+    BASE_VARIANT_SWITCH_CASES_4(0);
+    BASE_VARIANT_SWITCH_CASES_4(4);
+    BASE_VARIANT_SWITCH_CASES_4(8);
+    BASE_VARIANT_SWITCH_CASES_4(12);
+    BASE_VARIANT_SWITCH_CASES_4(16);
+    BASE_VARIANT_SWITCH_CASES_4(20);
+    BASE_VARIANT_SWITCH_CASES_4(24);
+    BASE_VARIANT_SWITCH_CASES_4(28);
+    default:
+      BASE_VARIANT_UNREACHABLE();
+  }
+
+#undef BASE_VARIANT_SWITCH_CASES_4
+#undef BASE_VARIANT_SWITCH_CASE
+}
+
+static_assert(BASE_VARIANT_MAX_SWITCH_CASES <= 32,
+              "dispatch_index switch has only 32 cases.");
+
+// Converts runtime index `i` into compile time one, i.e calls
+// `h(std::integral_constant<std::size_t, i>{})`. `i` must be less than `n`.
+template <class R, std::size_t n, class H>
+constexpr R dispatch_index(std::size_t i, H&& h) {
+  return dispatch_index_impl<R, n>(
+      std::integral_constant<bool, (n <= BASE_VARIANT_MAX_SWITCH_CASES)>{}, i,
+      std::forward<H>(h));
+}
+
+template <class R, class F, class V>
+struct single_visit_handler {
+  template <std::size_t I>
+  constexpr R operator()(std::integral_constant<std::size_t, I>) const {
+    constexpr std::size_t id = I + visit_offset<std::decay_t<V>>;
+    return visit_concrete<R, std::index_sequence<id>, id == 0, F&&, V&&>(
+        std::forward<F>(f), std::forward<V>(v));
+  }
+
+  F&& f;
+  V&& v;
+};
+
+// Single variant case does not need any matrix, so it goes through
+// `dispatch_index` and benefits from `switch` for small variants.
+template <class R, class F, class V>
+constexpr R visit_single(F&& f, V&& v) {
+  return dispatch_index<R, visit_dimension<std::decay_t<V>>>(
+      v.index() + 1 - visit_offset<std::decay_t<V>>,
+      single_visit_handler<R, F, V>{std::forward<F>(f), std::forward<V>(v)});
+}
+
+template <class R, class F, class... Vs>
+struct nested_visit_state {
+  F&& f;
+  std::tuple<Vs&&...> vs;
+};
+
+template <class R, class Indexes, class F, class... Vs, std::size_t... Is>
+constexpr R visit_nested_call(const nested_visit_state<R, F, Vs...>& s,
+                              std::index_sequence<Is...>) {
+  return visit_concrete<R, Indexes, check_valueless(Indexes{}), F&&, Vs&&...>(
+      std::forward<F>(s.f), std::forward<Vs>(std::get<Is>(s.vs))...);
+}
+
+// All the variants are resolved (or one of them is valueless).
+template <class R, class Indexes, class F, class... Vs>
+constexpr R visit_nested_step(std::true_type, Indexes,
+                              const nested_visit_state<R, F, Vs...>& s) {
+  return visit_nested_call<R, Indexes>(s, std::index_sequence_for<Vs...>{});
+}
+
+template <class R, class Indexes, class F, class... Vs>
+struct nested_visit_handler;
+
+// Resolves variant number `sizeof...(ids)`.
+template <class R, std::size_t... ids, class F, class... Vs>
+constexpr R visit_nested_step(std::false_type, std::index_sequence<ids...>,
+                              const nested_visit_state<R, F, Vs...>& s) {
+  constexpr std::size_t level = sizeof...(ids);
+  using V = std::decay_t<base::type_pack_element_t<level, Vs...>>;
+  return dispatch_index<R, visit_dimension<V>>(
+      std::get<level>(s.vs).index() + 1 - visit_offset<V>,
+      nested_visit_handler<R, std::index_sequence<ids...>, F, Vs...>{s});
+}
 
-  using FakeSizes = std::index_sequence<
-      1 + base::template_parameters_count_v<std::decay_t<Vs>>...>;
+template <class R, std::size_t... ids, class F, class... Vs>
+struct nested_visit_handler<R, std::index_sequence<ids...>, F, Vs...> {
+  template <std::size_t I>
+  constexpr R operator()(std::integral_constant<std::size_t, I>) const {
+    using V = std::decay_t<base::type_pack_element_t<sizeof...(ids), Vs...>>;
+    constexpr std::size_t id = I + visit_offset<V>;
+    constexpr bool done = id == 0 || sizeof...(ids) + 1 == sizeof...(Vs);
+    return visit_nested_step<R>(std::integral_constant<bool, done>{},
+                                std::index_sequence<ids..., id>{}, s);
+  }
 
-  static constexpr handler_type handlers[] = {
-      visit_concrete<R, IndexPacks, check_valueless(IndexPacks{}), F&&,
-                     Vs&&...>...};
+  const nested_visit_state<R, F, Vs...>& s;
+};
 
-  const std::size_t idx =
-      matops::normal_to_flat_index(FakeSizes{}, (vs.index() + 1)...);
+// Dispatches variants one by one: resolves index of the first variant, then
+// of the second one and so on. Every level is a single variant dispatch, so no
+// matrix of indexes is built, and valueless variant stops the resolution
+// right away.
+template <class R, class F, class... Vs>
+constexpr R visit_nested(F&& f, Vs&&... vs) {
+  return visit_nested_step<R>(
+      std::false_type{}, std::index_sequence<>{},
+      nested_visit_state<R, F, Vs...>{
+          std::forward<F>(f), std::forward_as_tuple(std::forward<Vs>(vs)...)});
+}
 
-  return handlers[idx](std::forward<F>(f), std::forward<Vs>(vs)...);
+template <class R, class F, class V>
+constexpr R visit(F&& f, V&& v) {
+  return visit_single<R>(std::forward<F>(f), std::forward<V>(v));
 }
 
-template <class R, class F, class T>
-R call_if_same(F&& f, T&& a, T&& b) {
-  return std::forward<F>(f)(std::forward<T>(a), std::forward<T>(b));
+template <class R, class F, class... Vs>
+constexpr R visit(F&& f, Vs&&... vs) {
+#if BASE_VARIANT_NESTED_MULTI_VISIT
+  return visit_nested<R>(std::forward<F>(f), std::forward<Vs>(vs)...);
+#else
+  return visit_matrix<R>(
+      std::forward<F>(f),
+      matops::build_all_matrix_indexes(
+          std::index_sequence<visit_dimension<std::decay_t<Vs>>...>{}),
+      std::forward<Vs>(vs)...);
+#endif
 }
 
-template <class R, class F, class T, class U>
-R call_if_same(F&&, T&&, U&&) {  // Will never be called
-  std::terminate();
+template <class R, class F, class V1, class V2>
+struct same_visit_handler {
+  template <std::size_t I>
+  constexpr R operator()(std::integral_constant<std::size_t, I>) const {
+    return std::forward<F>(f)(variant_accessor::get<I>(std::forward<V1>(a)),
+                              variant_accessor::get<I>(std::forward<V2>(b)));
+  }
+
+  F&& f;
+  V1&& a;
+  V2&& b;
+};
+
+// Calls `f(get<I>(a), get<I>(b))`, where `I == a.index() == b.index()`.
+// Neither of variants may be valueless. Unlike two variants `visit`, needs
+// only one handler per alternative instead of the whole matrix.
+template <class R, class F, class V1, class V2>
+constexpr R visit_same(F&& f, V1&& a, V2&& b) {
+  return dispatch_index<R, alternatives_count<std::decay_t<V1>>>(
+      a.index(), same_visit_handler<R, F, V1, V2>{std::forward<F>(f),
+                                                  std::forward<V1>(a),
+                                                  std::forward<V2>(b)});
 }
 
 }  // namespace detail
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "variant.h"
+
+namespace base {
+
+// Variant that never becomes valueless by exception.
+//
+// All the alternatives must be nothrow move constructible. When constructing
+// an alternative may throw, it is constructed into temporary first and then
+// moved into the storage, so the old value stays untouched if construction
+// fails. In exchange, visitation doesn't need any handlers for the valueless
+// state and comparisons don't check for it.
+//
+// `variant<Ts...>` is a private base, so its modifiers, which may leave it
+// valueless, can't be reached through a `variant<Ts...>&`. `get`, `get_if`,
+// `try_get`, `holds_alternative` and `visit` are overloaded below. They work
+// for classes publicly derived from `never_empty_variant` as well, which are
+// visited without the valueless state too.
+template <class... Ts>
+class never_empty_variant : private variant<Ts...> {
+  using base_type = variant<Ts...>;
+
+  static_assert(
+      base::conjunction_v<std::is_nothrow_move_constructible<Ts>...>,
+      "never_empty_variant alternatives must be nothrow move constructible.");
+
+ public:
+  using base_type::base_type;
+  using base_type::index;
+
+  template <class T, class TDec = std::decay_t<T>,
+            std::size_t index = detail::alternative_index<TDec, Ts...>>
+  std::enable_if_t<index != variant_npos, never_empty_variant&> operator=(
+      T&& value) {
+    if (index == this->index()) {
+      *get_if<index>(this) = std::forward<T>(value);
+    } else {
+      emplace<index>(std::forward<T>(value));
+    }
+    return *this;
+  }
+
+  // -------------------- OBSERVERS --------------------
+
+  constexpr bool valueless_by_exception() const noexcept { return false; }
+
+  // -------------------- MODIFIERS --------------------
+
+  template <std::size_t I, class... Args>
+  std::enable_if_t<std::is_constructible<variant_alternative_t<I, base_type>,
+                                         Args...>::value,
+                   variant_alternative_t<I, base_type>>&
+  emplace(Args&&... args) {
+    using T = variant_alternative_t<I, base_type>;
+    return emplace_impl<I>(std::is_nothrow_constructible<T, Args...>{},
+                           std::forward<Args>(args)...);
+  }
+
+  template <class T, class... Args,
+            std::size_t index = detail::alternative_index<T, Ts...>>
+  auto emplace(Args&&... args)
+      -> decltype(emplace<index>(std::forward<Args>(args)...)) {
+    return emplace<index>(std::forward<Args>(args)...);
+  }
+
+  void swap(never_empty_variant& rhs) { base_type::swap(rhs); }
+
+ private:
+  template <std::size_t I, class... Args>
+  variant_alternative_t<I, base_type>& emplace_impl(std::true_type,
+                                                    Args&&... args) {
+    return base_type::template emplace<I>(std::forward<Args>(args)...);
+  }
+
+  template <std::size_t I, class... Args>
+  variant_alternative_t<I, base_type>& emplace_impl(std::false_type,
+                                                    Args&&... args) {
+    auto tmp = variant_alternative_t<I, base_type>(std::forward<Args>(args)...);
+    return base_type::template emplace<I>(std::move(tmp));
+  }
+
+  friend struct detail::variant_accessor;
+};
+
+// -------------------- ACCESS --------------------
+//
+// Same as for `variant<Ts...>`, which is a private base of
+// `never_empty_variant<Ts...>`.
+
+template <std::size_t I, class... Ts>
+constexpr detail::alternative_type_t<I, Ts...>& get(
+    never_empty_variant<Ts...>& v) {
+  return get<I>(detail::variant_accessor::as_variant(v));
+}
+
+template <std::size_t I, class... Ts>
+constexpr const detail::alternative_type_t<I, Ts...>& get(
+    const never_empty_variant<Ts...>& v) {
+  return get<I>(detail::variant_accessor::as_variant(v));
+}
+
+template <std::size_t I, class... Ts>
+constexpr detail::alternative_type_t<I, Ts...>&& get(
+    never_empty_variant<Ts...>&& v) {
+  return get<I>(detail::variant_accessor::as_variant(std::move(v)));
+}
+
+template <std::size_t I, class... Ts>
+constexpr const detail::alternative_type_t<I, Ts...>&& get(
+    const never_empty_variant<Ts...>&& v) {
+  return get<I>(detail::variant_accessor::as_variant(std::move(v)));
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(never_empty_variant<Ts...>& v) -> decltype(get<index>(v)) {
+  return get<index>(v);
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(const never_empty_variant<Ts...>& v)
+    -> decltype(get<index>(v)) {
+  return get<index>(v);
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(never_empty_variant<Ts...>&& v)
+    -> decltype(get<index>(std::move(v))) {
+  return get<index>(std::move(v));
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(const never_empty_variant<Ts...>&& v)
+    -> decltype(get<index>(std::move(v))) {
+  return get<index>(std::move(v));
+}
+
+template <std::size_t I, class... Ts>
+constexpr std::add_pointer_t<detail::alternative_type_t<I, Ts...>> get_if(
+    never_empty_variant<Ts...>* v) noexcept {
+  return v != nullptr ? get_if<I>(&detail::variant_accessor::as_variant(*v))
+                      : nullptr;
+}
+
+template <std::size_t I, class... Ts>
+constexpr std::add_pointer_t<const detail::alternative_type_t<I, Ts...>>
+get_if(const never_empty_variant<Ts...>* v) noexcept {
+  return v != nullptr ? get_if<I>(&detail::variant_accessor::as_variant(*v))
+                      : nullptr;
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get_if(never_empty_variant<Ts...>* v) noexcept
+    -> decltype(get_if<index>(v)) {
+  return get_if<index>(v);
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get_if(const never_empty_variant<Ts...>* v) noexcept
+    -> decltype(get_if<index>(v)) {
+  return get_if<index>(v);
+}
+
+template <std::size_t I, class... Ts>
+constexpr std::add_pointer_t<detail::alternative_type_t<I, Ts...>> try_get(
+    never_empty_variant<Ts...>& v) noexcept {
+  return get_if<I>(&v);
+}
+
+template <std::size_t I, class... Ts>
+constexpr std::add_pointer_t<const detail::alternative_type_t<I, Ts...>>
+try_get(const never_empty_variant<Ts...>& v) noexcept {
+  return get_if<I>(&v);
+}
+
+template <std::size_t I, class... Ts>
+void try_get(const never_empty_variant<Ts...>&&) = delete;
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto try_get(never_empty_variant<Ts...>& v) noexcept
+    -> decltype(get_if<index>(&v)) {
+  return get_if<index>(&v);
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto try_get(const never_empty_variant<Ts...>& v) noexcept
+    -> decltype(get_if<index>(&v)) {
+  return get_if<index>(&v);
+}
+
+template <class T, class... Ts>
+void try_get(const never_empty_variant<Ts...>&&) = delete;
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr std::enable_if_t<index != variant_npos, bool> holds_alternative(
+    const never_empty_variant<Ts...>& v) noexcept {
+  return index == v.index();
+}
+
+template <std::size_t I, class... Ts>
+struct variant_alternative<I, never_empty_variant<Ts...>>
+    : variant_alternative<I, variant<Ts...>> {};
+
+template <class... Ts>
+struct variant_size<never_empty_variant<Ts...>>
+    : variant_size<variant<Ts...>> {};
+
+template <class... Ts>
+bool operator==(const never_empty_variant<Ts...>& a,
+                const never_empty_variant<Ts...>& b) {
+  return a.index() == b.index() &&
+         detail::visit_same<bool>(
+             [](const auto& x, const auto& y) { return x == y; }, a, b);
+}
+
+template <class... Ts>
+bool operator!=(const never_empty_variant<Ts...>& a,
+                const never_empty_variant<Ts...>& b) {
+  return a.index() != b.index() ||
+         detail::visit_same<bool>(
+             [](const auto& x, const auto& y) { return x != y; }, a, b);
+}
+
+template <class... Ts>
+bool operator<(const never_empty_variant<Ts...>& a,
+               const never_empty_variant<Ts...>& b) {
+  if (a.index() == b.index()) {
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x < y; }, a, b);
+  }
+  return a.index() < b.index();
+}
+
+template <class... Ts>
+bool operator>(const never_empty_variant<Ts...>& a,
+               const never_empty_variant<Ts...>& b) {
+  if (a.index() == b.index()) {
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x > y; }, a, b);
+  }
+  return a.index() > b.index();
+}
+
+template <class... Ts>
+bool operator<=(const never_empty_variant<Ts...>& a,
+                const never_empty_variant<Ts...>& b) {
+  if (a.index() == b.index()) {
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x <= y; }, a, b);
+  }
+  return a.index() < b.index();
+}
+
+template <class... Ts>
+bool operator>=(const never_empty_variant<Ts...>& a,
+                const never_empty_variant<Ts...>& b) {
+  if (a.index() == b.index()) {
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x >= y; }, a, b);
+  }
+  return a.index() > b.index();
+}
+
+template <class... Ts>
+struct is_trivially_relocatable<never_empty_variant<Ts...>>
+    : is_trivially_relocatable<variant<Ts...>> {};
+
+}  // namespace base
+
+namespace std {
+
+// Same hash as for `variant<Ts...>` holding the same alternative.
+template <class... Ts>
+struct hash<base::never_empty_variant<Ts...>> : hash<base::variant<Ts...>> {
+  std::size_t operator()(const base::never_empty_variant<Ts...>& v) const {
+    return hash<base::variant<Ts...>>::operator()(
+        base::detail::variant_accessor::as_variant(v));
+  }
+};
+
+}  // namespace std
@@ -0,0 +1,187 @@
+#include "never_empty_variant.h"
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "catch2/catch_all.hpp"
+#include "test_util.h"
+
+namespace {
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+struct throw_on_construct {
+  throw_on_construct() { throw std::runtime_error{"throw_on_construct"}; }
+  throw_on_construct(int) {}
+};
+
+struct throw_on_copy {
+  throw_on_copy() = default;
+  throw_on_copy(const throw_on_copy&) {
+    throw std::runtime_error{"throw_on_copy"};
+  }
+  throw_on_copy(throw_on_copy&&) noexcept = default;
+  throw_on_copy& operator=(const throw_on_copy&) = default;
+  throw_on_copy& operator=(throw_on_copy&&) noexcept = default;
+};
+#else
+// Without exceptions it's only constructed from `int`, which doesn't throw.
+struct throw_on_construct {
+  throw_on_construct(int) {}
+};
+#endif
+
+template <class To, class From, class = void>
+struct is_static_castable : std::false_type {};
+
+template <class To, class From>
+struct is_static_castable<
+    To, From, base::void_t<decltype(static_cast<To>(std::declval<From>()))>>
+    : std::true_type {};
+
+// Classes derived from `never_empty_variant` are never empty too.
+struct derived_var_t : base::never_empty_variant<int, std::string> {
+  using never_empty_variant::never_empty_variant;
+};
+
+}  // namespace
+
+TEST_CASE("Never empty variant test", "[never_empty_variant]") {
+  using var_t = base::never_empty_variant<int, std::string, throw_on_construct>;
+
+  static_assert(base::variant_size_v<var_t> == 3, "");
+  static_assert(
+      std::is_same<base::variant_alternative_t<1, var_t>, std::string>::value,
+      "");
+  // No handlers are reserved for the valueless state.
+  static_assert(base::detail::visit_dimension<var_t> == 3, "");
+  static_assert(base::detail::visit_dimension<base::variant<int>> == 2, "");
+
+  var_t v = 5;
+  REQUIRE(0 == v.index());
+  REQUIRE(!v.valueless_by_exception());
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  SECTION("Throwing emplace keeps the old value") {
+    REQUIRE_THROWS_AS(v.emplace<2>(), std::runtime_error);
+    REQUIRE(!v.valueless_by_exception());
+    REQUIRE(base::holds_alternative<int>(v));
+    REQUIRE(5 == base::get<int>(v));
+
+    v.emplace<throw_on_construct>(1);
+    REQUIRE(2 == v.index());
+  }
+#endif
+
+  SECTION("Assignment and visitation") {
+    v = std::string{"abc"};
+    REQUIRE(base::get<std::string>(v) == "abc");
+    v = 7;
+    REQUIRE(base::visit(
+        [](const auto& value) {
+          return std::is_same<std::decay_t<decltype(value)>, int>::value;
+        },
+        v));
+
+    var_t other = std::string{"def"};
+    v = other;
+    REQUIRE(base::get<1>(v) == "def");
+    v.swap(other);
+    REQUIRE(base::get<1>(v) == "def");
+  }
+
+  SECTION("Multi visitation") {
+    var_t other = std::string{"abc"};
+    auto result = base::visit(
+        [](const auto& a, const auto& b) -> int {
+          return std::is_same<std::decay_t<decltype(a)>, int>::value &&
+                 std::is_same<std::decay_t<decltype(b)>, std::string>::value;
+        },
+        v, other);
+    REQUIRE(result == 1);
+  }
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Never empty variant throwing copy test", "[never_empty_variant]") {
+  using var_t = base::never_empty_variant<int, throw_on_copy>;
+
+  var_t v = 1;
+  const auto value = throw_on_copy{};
+  REQUIRE_THROWS_AS(v = value, std::runtime_error);
+  REQUIRE(base::holds_alternative<int>(v));
+
+  const var_t other{base::in_place_index<1>};
+  REQUIRE_THROWS_AS(v = other, std::runtime_error);
+  REQUIRE(base::holds_alternative<int>(v));
+  REQUIRE(1 == base::get<0>(v));
+}
+#endif
+
+TEST_CASE("Never empty variant comparison test", "[never_empty_variant]") {
+  using var_t = base::never_empty_variant<int, std::string>;
+
+  REQUIRE(var_t{1} == var_t{1});
+  REQUIRE(var_t{1} != var_t{2});
+  REQUIRE(var_t{1} < var_t{std::string{}});
+  REQUIRE(var_t{std::string{"b"}} > var_t{std::string{"a"}});
+  REQUIRE(var_t{1} <= var_t{1});
+  REQUIRE(var_t{2} >= var_t{1});
+}
+
+TEST_CASE("Never empty variant hides variant modifiers",
+          "[never_empty_variant]") {
+  using var_t = base::never_empty_variant<int, std::string, throw_on_construct>;
+  using variant_t = base::variant<int, std::string, throw_on_construct>;
+
+  // `variant` modifiers could leave it valueless, so the base is inaccessible.
+  static_assert(!std::is_convertible<var_t&, variant_t&>::value, "");
+  static_assert(!std::is_convertible<const var_t*, const variant_t*>::value,
+                "");
+  static_assert(!is_static_castable<variant_t&, var_t&>::value, "");
+  static_assert(!is_static_castable<variant_t&&, var_t&&>::value, "");
+
+  var_t v = std::string{"abc"};
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  REQUIRE_THROWS_AS(v.emplace<2>(), std::runtime_error);
+  REQUIRE_THROWS_AS(v.emplace<throw_on_construct>(), std::runtime_error);
+#endif
+  REQUIRE(!v.valueless_by_exception());
+  REQUIRE(base::visit([](const auto& value) { return sizeof(value); }, v) ==
+          sizeof(std::string));
+
+  // Accessors are provided for `never_empty_variant` itself.
+  REQUIRE(base::holds_alternative<std::string>(v));
+  REQUIRE(base::get<1>(v) == "abc");
+  REQUIRE(base::get<std::string>(static_cast<const var_t&>(v)) == "abc");
+  REQUIRE(base::get<1>(var_t{v}) == "abc");
+  REQUIRE(base::get_if<int>(&v) == nullptr);
+  REQUIRE(*base::get_if<1>(&v) == "abc");
+  REQUIRE(base::try_get<int>(v) == nullptr);
+  REQUIRE(*base::try_get<std::string>(v) == "abc");
+  REQUIRE_RAISES_AS(base::get<int>(v), base::bad_variant_access);
+
+  using hashable_t = base::never_empty_variant<int, std::string>;
+  REQUIRE(std::hash<hashable_t>{}(hashable_t{2}) ==
+          std::hash<base::variant<int, std::string>>{}(2));
+}
+
+TEST_CASE("Never empty variant derived class test", "[never_empty_variant]") {
+  static_assert(base::detail::is_never_empty<derived_var_t>::value, "");
+  static_assert(!base::detail::is_never_empty<base::variant<int>>::value, "");
+  static_assert(base::detail::alternatives_count<derived_var_t> == 2, "");
+  // No row for the valueless state, same as for the base.
+  static_assert(base::detail::visit_dimension<derived_var_t> == 2, "");
+
+  derived_var_t v{std::string{"abc"}};
+  REQUIRE(v.index() == 1);
+  REQUIRE(base::visit([](const auto& value) { return sizeof(value); }, v) ==
+          sizeof(std::string));
+  REQUIRE(base::get<std::string>(v) == "abc");
+  REQUIRE(base::holds_alternative<std::string>(v));
+  v = 3;
+  REQUIRE(base::get<int>(v) == 3);
+  REQUIRE(v == derived_var_t{3});
+  REQUIRE(v < derived_var_t{std::string{}});
+}
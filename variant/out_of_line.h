@@ -0,0 +1,153 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "variant.h"
+
+namespace base {
+
+// Owning box, which keeps a single `T` in memory obtained from `Alloc`.
+//
+// Variant treats `out_of_line<T>` alternatives transparently: `get`,
+// `get_if`, `holds_alternative` and `visit` see `T` rather than the box, so
+// large alternatives can be moved out of the variant without touching the code
+// working with it.
+//
+// Stateful allocator is passed as `out_of_line(std::allocator_arg, alloc,
+// args...)`, e.g. via `variant::emplace<I>(std::allocator_arg, alloc, ...)`.
+//
+// Moving the box steals the pointer and never allocates, so variants with
+// boxed alternatives stay nothrow move constructible and `std::vector` moves
+// rather than copies them on growth. Like `std::indirect`, the moved-from box
+// is left valueless: it may only be destroyed, assigned to or copied (the
+// copy is valueless too). Dereferencing it, and so `get`, `visit`, comparison
+// or hashing of the variant holding it, is undefined.
+//
+// Allocator is kept as a base, so stateless allocators take no space and the
+// box is exactly one pointer.
+template <class T, class Alloc = std::allocator<T>>
+class out_of_line
+    : private std::allocator_traits<Alloc>::template rebind_alloc<T> {
+  using alloc_traits =
+      typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+  using alloc_type = typename alloc_traits::allocator_type;
+
+ public:
+  template <class... Args,
+            class = std::enable_if_t<
+                std::is_constructible<T, Args...>::value &&
+                !std::is_same<base::type_pack<std::decay_t<Args>...>,
+                              base::type_pack<out_of_line>>::value>>
+  explicit out_of_line(Args&&... args)
+      : ptr_(create(std::forward<Args>(args)...)) {}
+
+  template <class... Args>
+  out_of_line(std::allocator_arg_t, const Alloc& alloc, Args&&... args)
+      : alloc_type(alloc), ptr_(create(std::forward<Args>(args)...)) {}
+
+  out_of_line(const out_of_line& rhs)
+      : alloc_type(alloc_traits::select_on_container_copy_construction(
+            rhs.alloc())),
+        ptr_(rhs.ptr_ != nullptr ? create(*rhs) : nullptr) {}
+
+  out_of_line(out_of_line&& rhs) noexcept
+      : alloc_type(std::move(rhs.alloc())), ptr_(rhs.ptr_) {
+    rhs.ptr_ = nullptr;
+  }
+
+  out_of_line& operator=(const out_of_line& rhs) {
+    if (rhs.ptr_ == nullptr) {
+      reset();
+    } else if (ptr_ == nullptr) {
+      ptr_ = create(*rhs);
+    } else {
+      **this = *rhs;
+    }
+    return *this;
+  }
+
+  // The values are exchanged together with allocators, so each of them is
+  // still freed by the allocator it came from.
+  out_of_line& operator=(out_of_line&& rhs) noexcept {
+    using std::swap;
+    swap(alloc(), rhs.alloc());
+    swap(ptr_, rhs.ptr_);
+    return *this;
+  }
+
+  // Assigns the value, allocating a new box if this one was moved from.
+  template <class U,
+            class = std::enable_if_t<
+                !std::is_same<std::decay_t<U>, out_of_line>::value &&
+                std::is_constructible<T, U>::value &&
+                std::is_assignable<T&, U>::value>>
+  out_of_line& operator=(U&& value) {
+    if (ptr_ == nullptr) {
+      ptr_ = create(std::forward<U>(value));
+    } else {
+      **this = std::forward<U>(value);
+    }
+    return *this;
+  }
+
+  ~out_of_line() { reset(); }
+
+  // Whether the box was moved from and holds no value.
+  bool valueless_after_move() const noexcept { return ptr_ == nullptr; }
+
+  T& operator*() noexcept { return *ptr_; }
+  const T& operator*() const noexcept { return *ptr_; }
+
+  T* operator->() noexcept { return ptr_; }
+  const T* operator->() const noexcept { return ptr_; }
+
+ private:
+  alloc_type& alloc() noexcept { return *this; }
+  const alloc_type& alloc() const noexcept { return *this; }
+
+  void reset() noexcept {
+    if (ptr_ != nullptr) {
+      alloc_traits::destroy(alloc(), ptr_);
+      alloc_traits::deallocate(alloc(), ptr_, 1);
+      ptr_ = nullptr;
+    }
+  }
+
+  template <class... Args>
+  T* create(Args&&... args) {
+    T* ptr = alloc_traits::allocate(alloc(), 1);
+    BASE_VARIANT_TRY {
+      alloc_traits::construct(alloc(), ptr, std::forward<Args>(args)...);
+    } BASE_VARIANT_CATCH_ALL {
+      alloc_traits::deallocate(alloc(), ptr, 1);
+      BASE_VARIANT_RETHROW;
+    }
+    return ptr;
+  }
+
+  T* ptr_;
+};
+
+// The box is a pointer and an allocator.
+template <class T, class Alloc>
+struct is_trivially_relocatable<out_of_line<T, Alloc>>
+    : is_trivially_relocatable<
+          typename std::allocator_traits<Alloc>::template rebind_alloc<T>> {};
+
+namespace detail {
+
+template <class T, class Alloc>
+struct unboxed<out_of_line<T, Alloc>> {
+  using type = T;
+
+  static T& get(out_of_line<T, Alloc>& box) noexcept { return *box; }
+  static const T& get(const out_of_line<T, Alloc>& box) noexcept {
+    return *box;
+  }
+};
+
+}  // namespace detail
+
+}  // namespace base
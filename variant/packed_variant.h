@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "variant.h"
+
+namespace base {
+
+namespace detail {
+
+template <std::size_t value>
+constexpr std::size_t log2_floor = value < 2 ? 0 : 1 + log2_floor<value / 2>;
+
+template <class... Ts>
+constexpr std::size_t min_pointee_alignment() {
+  const std::size_t alignments[] = {alignof(std::remove_pointer_t<Ts>)...};
+  std::size_t result = alignments[0];
+  for (const std::size_t a : alignments) {
+    result = a < result ? a : result;
+  }
+  return result;
+}
+
+}  // namespace detail
+
+// Variant of raw pointers, which keeps the index in the low bits of the
+// pointer itself, so it's exactly pointer sized.
+//
+// All the pointees must be aligned enough to leave room for the index, e.g.
+// up to 8 alternatives pointing to 8-byte aligned types. Alternatives are
+// stored by value, so unlike `variant`:
+//  - `get` returns a copy of the pointer and `get_if` returns the pointer
+//    itself or `nullptr`, if another alternative is held;
+//  - `visit` passes the pointer by value and supports one variant at a time.
+// Never valueless.
+template <class... Ts>
+class packed_variant {
+  static_assert(sizeof...(Ts) > 0, "variant type list cannot be empty.");
+  static_assert(base::conjunction_v<std::is_pointer<Ts>...>,
+                "packed_variant alternatives must be pointers.");
+  static_assert(
+      base::conjunction_v<std::is_object<std::remove_pointer_t<Ts>>...>,
+      "packed_variant alternatives must point to complete object types.");
+
+  // Number of low bits, which are always zero in a pointer to any of the
+  // alternatives.
+  static constexpr int index_bits =
+      detail::log2_floor<detail::min_pointee_alignment<Ts...>()>;
+  static constexpr std::uintptr_t index_mask =
+      (std::uintptr_t{1} << index_bits) - 1;
+
+  static_assert(sizeof...(Ts) - 1 <= index_mask,
+                "pointees alignment leaves no room for the index.");
+
+ public:
+  constexpr packed_variant() noexcept : bits_(0) {}
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>,
+            class = std::enable_if_t<index != variant_npos>>
+  packed_variant(T ptr) noexcept : bits_(pack<index>(ptr)) {}
+
+  template <std::size_t I>
+  packed_variant(in_place_index_t<I>,
+                 base::type_pack_element_t<I, Ts...> ptr) noexcept
+      : bits_(pack<I>(ptr)) {}
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, packed_variant&> operator=(
+      T ptr) noexcept {
+    bits_ = pack<index>(ptr);
+    return *this;
+  }
+
+  // -------------------- OBSERVERS --------------------
+
+  constexpr std::size_t index() const noexcept { return bits_ & index_mask; }
+
+  constexpr bool valueless_by_exception() const noexcept { return false; }
+
+  // -------------------- MODIFIERS --------------------
+
+  template <std::size_t I>
+  base::type_pack_element_t<I, Ts...> emplace(
+      base::type_pack_element_t<I, Ts...> ptr) noexcept {
+    bits_ = pack<I>(ptr);
+    return ptr;
+  }
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, T> emplace(T ptr) noexcept {
+    return emplace<index>(ptr);
+  }
+
+  void swap(packed_variant& rhs) noexcept { std::swap(bits_, rhs.bits_); }
+
+  // Pointer held by the variant, must be alternative number `index()`.
+  template <std::size_t I>
+  base::type_pack_element_t<I, Ts...> unchecked_get() const noexcept {
+    return reinterpret_cast<base::type_pack_element_t<I, Ts...>>(bits_ &
+                                                                 ~index_mask);
+  }
+
+  friend bool operator==(packed_variant a, packed_variant b) noexcept {
+    return a.bits_ == b.bits_;
+  }
+
+  friend bool operator!=(packed_variant a, packed_variant b) noexcept {
+    return a.bits_ != b.bits_;
+  }
+
+  // Ordered by index first and by pointer value then, like `variant`.
+  friend bool operator<(packed_variant a, packed_variant b) noexcept {
+    return a.rotated() < b.rotated();
+  }
+
+  friend bool operator>(packed_variant a, packed_variant b) noexcept {
+    return b < a;
+  }
+
+  friend bool operator<=(packed_variant a, packed_variant b) noexcept {
+    return !(b < a);
+  }
+
+  friend bool operator>=(packed_variant a, packed_variant b) noexcept {
+    return !(a < b);
+  }
+
+ private:
+  template <std::size_t I, class T>
+  static std::uintptr_t pack(T ptr) noexcept {
+    return reinterpret_cast<std::uintptr_t>(ptr) | I;
+  }
+
+  // Moves the index into the high bits, so plain integer comparison orders
+  // by index first.
+  std::uintptr_t rotated() const noexcept {
+    constexpr int bits = sizeof(std::uintptr_t) * 8;
+    return index_bits == 0
+               ? bits_
+               : (bits_ << (bits - index_bits)) | (bits_ >> index_bits);
+  }
+
+  std::uintptr_t bits_;
+};
+
+template <std::size_t I, class... Ts>
+struct variant_alternative<I, packed_variant<Ts...>>
+    : base::type_pack_element<I, Ts...> {};
+
+template <class... Ts>
+struct variant_size<packed_variant<Ts...>>
+    : base::template_parameters_count<packed_variant<Ts...>> {};
+
+template <class T, class... Ts,
+          std::size_t index = detail::index_of<T, Ts...>>
+constexpr std::enable_if_t<index != variant_npos, bool> holds_alternative(
+    packed_variant<Ts...> v) noexcept {
+  return index == v.index();
+}
+
+template <std::size_t I, class... Ts>
+base::type_pack_element_t<I, Ts...> get(packed_variant<Ts...> v) {
+  if (I != v.index()) {
+    detail::raise<bad_variant_access>();
+  }
+  return v.template unchecked_get<I>();
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::index_of<T, Ts...>>
+std::enable_if_t<index != variant_npos, T> get(packed_variant<Ts...> v) {
+  return get<index>(v);
+}
+
+template <std::size_t I, class... Ts>
+base::type_pack_element_t<I, Ts...> get_if(
+    const packed_variant<Ts...>* v) noexcept {
+  return v != nullptr && I == v->index() ? v->template unchecked_get<I>()
+                                         : nullptr;
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::index_of<T, Ts...>>
+std::enable_if_t<index != variant_npos, T> get_if(
+    const packed_variant<Ts...>* v) noexcept {
+  return get_if<index>(v);
+}
+
+namespace detail {
+
+template <class R, class F, class... Ts>
+struct packed_visit_handler {
+  template <std::size_t I>
+  R operator()(std::integral_constant<std::size_t, I>) const {
+    return invoke_r<R>::call(std::forward<F>(f),
+                             v.template unchecked_get<I>());
+  }
+
+  F&& f;
+  packed_variant<Ts...> v;
+};
+
+template <class F, class... Ts>
+using packed_visit_result_t =
+    base::invoke_result_t<F, base::type_pack_element_t<0, Ts...>>;
+
+}  // namespace detail
+
+template <class F, class... Ts,
+          class Result = detail::packed_visit_result_t<F&&, Ts...>>
+Result visit(F&& f, packed_variant<Ts...> v) {
+  static_assert(
+      detail::types_are_same<Result, base::invoke_result_t<F&&, Ts>...>,
+      "visitor must return the same type for every alternative.");
+  return visit<Result>(std::forward<F>(f), v);
+}
+
+template <class R, class F, class... Ts>
+R visit(F&& f, packed_variant<Ts...> v) {
+  return detail::dispatch_index<R, sizeof...(Ts)>(
+      v.index(),
+      detail::packed_visit_handler<R, F, Ts...>{std::forward<F>(f), v});
+}
+
+}  // namespace base
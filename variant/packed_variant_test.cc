@@ -0,0 +1,89 @@
+#include "packed_variant.h"
+
+#include <string>
+
+#include "catch2/catch_all.hpp"
+#include "test_util.h"
+
+namespace {
+
+struct alignas(8) leaf {
+  int value;
+};
+
+struct alignas(8) node {
+  std::string name;
+};
+
+}  // namespace
+
+TEST_CASE("Packed variant layout test", "[packed_variant]") {
+  using var_t = base::packed_variant<int*, leaf*, const node*, double*>;
+
+  static_assert(sizeof(var_t) == sizeof(void*), "");
+  static_assert(std::is_trivially_copyable<var_t>::value, "");
+  static_assert(base::variant_size_v<var_t> == 4, "");
+  static_assert(
+      std::is_same<base::variant_alternative_t<2, var_t>, const node*>::value,
+      "");
+}
+
+TEST_CASE("Packed variant access test", "[packed_variant]") {
+  using var_t = base::packed_variant<int*, leaf*, const node*, double*>;
+
+  int i = 1;
+  leaf l{2};
+  const node n{"n"};
+
+  var_t v;
+  REQUIRE(v.index() == 0);
+  REQUIRE(base::get<0>(v) == nullptr);
+  REQUIRE(!v.valueless_by_exception());
+
+  v = &l;
+  REQUIRE(v.index() == 1);
+  REQUIRE(base::holds_alternative<leaf*>(v));
+  REQUIRE(base::get<leaf*>(v) == &l);
+  REQUIRE(base::get_if<1>(&v) == &l);
+  REQUIRE(base::get_if<int*>(&v) == nullptr);
+  REQUIRE_RAISES_AS(base::get<const node*>(v), base::bad_variant_access);
+
+  v.emplace<2>(&n);
+  REQUIRE(base::get<2>(v)->name == "n");
+
+  auto visitor = [](auto ptr) -> std::string {
+    return std::is_same<decltype(ptr), const node*>::value ? "node" : "other";
+  };
+  REQUIRE(base::visit(visitor, v) == "node");
+  REQUIRE(base::visit<std::string>(visitor, var_t{&i}) == "other");
+
+  // Null pointers keep the index.
+  v = static_cast<double*>(nullptr);
+  REQUIRE(v.index() == 3);
+  REQUIRE(base::get<double*>(v) == nullptr);
+}
+
+TEST_CASE("Packed variant comparison test", "[packed_variant]") {
+  using var_t = base::packed_variant<leaf*, node*>;
+
+  leaf leaves[2] = {};
+  node n;
+
+  REQUIRE(var_t{&leaves[0]} == var_t{&leaves[0]});
+  REQUIRE(var_t{&leaves[0]} != var_t{&leaves[1]});
+  REQUIRE(var_t{&leaves[0]} < var_t{&leaves[1]});
+  REQUIRE(var_t{&leaves[1]} <= var_t{&leaves[1]});
+
+  // Index is compared first.
+  REQUIRE(var_t{&leaves[1]} < var_t{&n});
+  REQUIRE(var_t{&n} > var_t{&leaves[0]});
+  REQUIRE(var_t{&n} >= var_t{&leaves[1]});
+  REQUIRE(var_t{base::in_place_index<0>, nullptr} !=
+          var_t{base::in_place_index<1>, nullptr});
+
+  var_t a = &leaves[0];
+  var_t b = &n;
+  a.swap(b);
+  REQUIRE(base::get<node*>(a) == &n);
+  REQUIRE(base::get<leaf*>(b) == &leaves[0]);
+}
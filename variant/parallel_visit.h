@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "thread_pool.h"
+#include "variant.h"
+#include "visit_each.h"
+
+namespace base {
+
+struct parallel_options {
+  // Pool to run on, `default_thread_pool()` if null.
+  thread_pool* pool = nullptr;
+
+  // Number of elements in one task. Tasks are the unit of scheduling and of
+  // reduction, so results depend on it but never on the number of threads.
+  std::size_t chunk_size = 4096;
+};
+
+namespace detail {
+
+template <class It>
+struct iterator_range {
+  It begin() const { return first; }
+  It end() const { return last; }
+
+  It first;
+  It last;
+};
+
+template <class It>
+iterator_range<It> make_iterator_range(It first, It last) {
+  return {first, last};
+}
+
+// Keeps `vector<bool>` away from concurrent writes.
+template <class T>
+struct reduce_slot {
+  T value;
+};
+
+// Calls `f(task, first, last)` for every chunk of the range in parallel.
+template <class It, class F>
+void for_each_chunk(It first, std::size_t n, const parallel_options& options,
+                    F&& f) {
+  const std::size_t chunk = std::max<std::size_t>(options.chunk_size, 1);
+  thread_pool& pool =
+      options.pool != nullptr ? *options.pool : default_thread_pool();
+  pool.run((n + chunk - 1) / chunk, [&](std::size_t task, std::size_t) {
+    const std::size_t begin = task * chunk;
+    const std::size_t end = std::min(n, begin + chunk);
+    f(task, first + begin, first + end);
+  });
+}
+
+}  // namespace detail
+
+// Parallel `visit_each`: splits random access `range` into chunks of
+// `options.chunk_size` elements and visits them on the thread pool, each
+// chunk with `visit_each`. `f` is shared by all the workers, so it's called
+// concurrently. The first exception thrown by `f` (or `bad_variant_access`
+// for a valueless element) is rethrown, the chunks not started by then are
+// skipped.
+template <class Range, class F>
+void parallel_visit(Range&& range, F&& f,
+                    const parallel_options& options = {}) {
+  auto first = std::begin(range);
+  auto visit_chunk = [&](std::size_t, auto begin, auto end) {
+    visit_each(detail::make_iterator_range(begin, end), f);
+  };
+  detail::for_each_chunk(first, std::distance(first, std::end(range)), options,
+                         visit_chunk);
+}
+
+// Parallel `visit_transform`: writes `visit(f, range[i])` into `out[i]`.
+template <class Range, class OutIt, class F>
+OutIt parallel_visit_transform(Range&& range, OutIt out, F&& f,
+                               const parallel_options& options = {}) {
+  auto first = std::begin(range);
+  const std::size_t n = std::distance(first, std::end(range));
+  auto transform_chunk = [&](std::size_t, auto begin, auto end) {
+    visit_transform(detail::make_iterator_range(begin, end),
+                    out + (begin - first), f);
+  };
+  detail::for_each_chunk(first, n, options, transform_chunk);
+  return out + n;
+}
+
+// Reduces `visit(f, x)` of all the elements `x` of `range` with associative
+// `reduce(T, T) -> T`, starting from `init`.
+//
+// Every chunk is folded in the range order by the worker which took it, and
+// the per-chunk results are then folded into `init` in the chunk order. So
+// for a fixed `options.chunk_size` the result is the same from run to run and
+// for any number of threads, even for floating point `reduce`.
+template <class Range, class T, class Reduce, class F>
+T parallel_visit_reduce(Range&& range, T init, Reduce reduce, F&& f,
+                        const parallel_options& options = {}) {
+  auto first = std::begin(range);
+  const std::size_t n = std::distance(first, std::end(range));
+  const std::size_t chunk = std::max<std::size_t>(options.chunk_size, 1);
+  // Copies of `init` are just placeholders for the per-chunk results.
+  auto partials = std::vector<detail::reduce_slot<T>>(
+      (n + chunk - 1) / chunk, detail::reduce_slot<T>{init});
+  auto reduce_chunk = [&](std::size_t task, auto begin, auto end) {
+    T acc = base::visit(f, *begin);
+    while (++begin != end) {
+      acc = reduce(std::move(acc), base::visit(f, *begin));
+    }
+    partials[task].value = std::move(acc);
+  };
+  detail::for_each_chunk(first, n, options, reduce_chunk);
+  for (auto& partial : partials) {
+    init = reduce(std::move(init), std::move(partial.value));
+  }
+  return init;
+}
+
+}  // namespace base
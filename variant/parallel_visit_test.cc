@@ -0,0 +1,116 @@
+#include "parallel_visit.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "test_util.h"
+
+namespace {
+
+using base::testing::throw_on_move;
+
+using var_t = base::variant<int, float, double>;
+
+std::vector<var_t> make_range(std::size_t n) {
+  return base::testing::make_mixed_range<std::vector<var_t>>(n);
+}
+
+struct to_double {
+  template <class T>
+  double operator()(T value) const {
+    return static_cast<double>(value);
+  }
+};
+
+}  // namespace
+
+TEST_CASE("Parallel visit test", "[parallel_visit]") {
+  base::thread_pool pool{4};
+  for (const std::size_t n : {0, 1, 10, 1000}) {
+    auto range = make_range(n);
+    std::atomic<std::size_t> ints{0};
+    base::parallel_visit(
+        range,
+        [&](auto& x) {
+          ints += std::is_same<std::decay_t<decltype(x)>, int>::value;
+          x += x;
+        },
+        {&pool, 64});
+    REQUIRE(ints == (n + 2) / 3);
+    for (std::size_t i = 0; i < n; ++i) {
+      REQUIRE(base::visit(to_double{}, range[i]) ==
+              2 * base::visit(to_double{}, make_range(n)[i]));
+    }
+  }
+}
+
+TEST_CASE("Parallel visit transform test", "[parallel_visit]") {
+  const auto range = make_range(1000);
+  std::vector<double> expected(range.size());
+  base::visit_transform(range, expected.begin(), to_double{});
+
+  for (const std::size_t threads : {1, 3}) {
+    base::thread_pool pool{threads};
+    for (const std::size_t chunk : {1, 7, 4096}) {
+      std::vector<double> results(range.size());
+      REQUIRE(base::parallel_visit_transform(range, results.begin(),
+                                             to_double{},
+                                             {&pool, chunk}) == results.end());
+      REQUIRE(results == expected);
+    }
+  }
+}
+
+TEST_CASE("Parallel visit reduce test", "[parallel_visit]") {
+  const auto range = make_range(10000);
+  const auto plus = [](double a, double b) { return a + b; };
+
+  // Same chunking gives bitwise equal results for any number of threads.
+  const double sequential = base::parallel_visit_reduce(
+      range, 0.5, plus, to_double{}, {nullptr, 100});
+  for (const std::size_t threads : {1, 2, 5}) {
+    base::thread_pool pool{threads};
+    REQUIRE(base::parallel_visit_reduce(range, 0.5, plus, to_double{},
+                                        {&pool, 100}) == sequential);
+  }
+  double expected = 0.5;
+  for (const auto& v : range) {
+    expected += base::visit(to_double{}, v);
+  }
+  REQUIRE(sequential == Approx(expected));
+
+  base::thread_pool pool{2};
+  const auto concat = [](std::string a, std::string b) { return a + b; };
+  const auto digits =
+      std::vector<base::variant<int, char>>{1, '2', 3, '4', 5, '6', 7};
+  const auto to_string = [](auto x) {
+    return std::is_same<decltype(x), int>::value
+               ? std::to_string(x)
+               : std::string(1, static_cast<char>(x));
+  };
+  REQUIRE(base::parallel_visit_reduce(digits, std::string{">"}, concat,
+                                      to_string, {&pool, 2}) == ">1234567");
+  REQUIRE(base::parallel_visit_reduce(std::vector<var_t>{}, 42, plus,
+                                      to_double{}, {&pool, 2}) == 42);
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Parallel visit exception test", "[parallel_visit]") {
+  base::thread_pool pool{2};
+  std::vector<base::variant<int, throw_on_move>> range(100);
+  REQUIRE_THROWS_AS(range[70].emplace<throw_on_move>(throw_on_move{}),
+                    std::runtime_error);
+  REQUIRE_THROWS_AS(
+      base::parallel_visit(range, [](const auto&) {}, {&pool, 10}),
+      base::bad_variant_access);
+  range[70] = 0;
+  REQUIRE_THROWS_AS(base::parallel_visit(
+                        range,
+                        [](const auto&) { throw std::runtime_error{"f"}; },
+                        {&pool, 10}),
+                    std::runtime_error);
+}
+#endif
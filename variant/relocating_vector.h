@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "internal/variant_traits.h"
+#include "trivially_relocatable.h"
+
+namespace base {
+
+// Contiguous sequence, like `std::vector<T>`, which relocates trivially
+// relocatable elements with `memcpy` (`memmove` when erasing) instead of
+// moving and destroying them one by one. Reallocation of a vector of such
+// elements is a single bandwidth-bound copy.
+//
+// Other elements are relocated like in `std::vector`: moved if their move is
+// nothrow and copied otherwise, so reallocation leaves the vector untouched
+// if it throws.
+template <class T>
+class relocating_vector {
+  static constexpr bool trivially_relocatable = is_trivially_relocatable_v<T>;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  relocating_vector() noexcept = default;
+
+  relocating_vector(std::initializer_list<T> values) {
+    reserve(values.size());
+    for (const T& value : values) {
+      push_back(value);
+    }
+  }
+
+  relocating_vector(const relocating_vector& rhs) {
+    reserve(rhs.size());
+    for (const T& value : rhs) {
+      push_back(value);
+    }
+  }
+
+  relocating_vector(relocating_vector&& rhs) noexcept { swap(rhs); }
+
+  relocating_vector& operator=(const relocating_vector& rhs) {
+    if (this != &rhs) {
+      relocating_vector{rhs}.swap(*this);
+    }
+    return *this;
+  }
+
+  relocating_vector& operator=(relocating_vector&& rhs) noexcept {
+    relocating_vector{std::move(rhs)}.swap(*this);
+    return *this;
+  }
+
+  ~relocating_vector() {
+    clear();
+    deallocate(begin_, capacity());
+  }
+
+  // -------------------- ITERATORS --------------------
+
+  iterator begin() noexcept { return begin_; }
+  const_iterator begin() const noexcept { return begin_; }
+  iterator end() noexcept { return end_; }
+  const_iterator end() const noexcept { return end_; }
+
+  // -------------------- CAPACITY --------------------
+
+  size_type size() const noexcept { return end_ - begin_; }
+  size_type capacity() const noexcept { return capacity_end_ - begin_; }
+  bool empty() const noexcept { return begin_ == end_; }
+
+  void reserve(size_type n) {
+    if (n > capacity()) {
+      reallocate(n);
+    }
+  }
+
+  // -------------------- ELEMENT ACCESS --------------------
+
+  T& operator[](size_type i) noexcept { return begin_[i]; }
+  const T& operator[](size_type i) const noexcept { return begin_[i]; }
+
+  T& front() noexcept { return *begin_; }
+  const T& front() const noexcept { return *begin_; }
+  T& back() noexcept { return end_[-1]; }
+  const T& back() const noexcept { return end_[-1]; }
+
+  T* data() noexcept { return begin_; }
+  const T* data() const noexcept { return begin_; }
+
+  // -------------------- MODIFIERS --------------------
+
+  template <class... Args>
+  T& emplace_back(Args&&... args) {
+    if (end_ == capacity_end_) {
+      return emplace_back_reallocating(std::forward<Args>(args)...);
+    }
+    ::new (static_cast<void*>(end_)) T(std::forward<Args>(args)...);
+    return *end_++;
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void pop_back() noexcept {
+    --end_;
+    end_->~T();
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    T* const from = const_cast<T*>(first);
+    T* const to = const_cast<T*>(last);
+    if (from == to) {
+      return from;
+    }
+    erase_impl(std::integral_constant<bool, trivially_relocatable>{}, from,
+               to);
+    return from;
+  }
+
+  void clear() noexcept {
+    destroy(begin_, end_);
+    end_ = begin_;
+  }
+
+  void swap(relocating_vector& rhs) noexcept {
+    std::swap(begin_, rhs.begin_);
+    std::swap(end_, rhs.end_);
+    std::swap(capacity_end_, rhs.capacity_end_);
+  }
+
+  friend void swap(relocating_vector& a, relocating_vector& b) noexcept {
+    a.swap(b);
+  }
+
+  friend bool operator==(const relocating_vector& a,
+                         const relocating_vector& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+
+  friend bool operator!=(const relocating_vector& a,
+                         const relocating_vector& b) {
+    return !(a == b);
+  }
+
+ private:
+  static T* allocate(size_type n) {
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  static void deallocate(T* ptr, size_type n) noexcept {
+    if (ptr != nullptr) {
+      std::allocator<T>{}.deallocate(ptr, n);
+    }
+  }
+
+  static void destroy(T* first, T* last) noexcept {
+    for (; first != last; ++first) {
+      first->~T();
+    }
+  }
+
+  size_type grown_capacity() const noexcept {
+    return std::max<size_type>(2 * capacity(), 1);
+  }
+
+  // Moves `[first, last)` into raw memory at `out` and ends the lifetime of
+  // the source. Either succeeds or leaves the source untouched.
+  static void relocate(std::true_type, T* first, T* last, T* out) noexcept {
+    if (first != last) {
+      std::memcpy(static_cast<void*>(out), static_cast<const void*>(first),
+                  (last - first) * sizeof(T));
+    }
+  }
+
+  static void relocate(std::false_type, T* first, T* last, T* out) {
+    T* const out_first = out;
+    BASE_VARIANT_TRY {
+      for (T* it = first; it != last; ++it, ++out) {
+        ::new (static_cast<void*>(out)) T(std::move_if_noexcept(*it));
+      }
+    } BASE_VARIANT_CATCH_ALL {
+      destroy(out_first, out);
+      BASE_VARIANT_RETHROW;
+    }
+    destroy(first, last);
+  }
+
+  void reallocate(size_type n) {
+    T* const buffer = allocate(n);
+    BASE_VARIANT_TRY {
+      relocate(std::integral_constant<bool, trivially_relocatable>{}, begin_,
+               end_, buffer);
+    } BASE_VARIANT_CATCH_ALL {
+      deallocate(buffer, n);
+      BASE_VARIANT_RETHROW;
+    }
+    adopt(buffer, size(), n);
+  }
+
+  void adopt(T* buffer, size_type size, size_type capacity) noexcept {
+    deallocate(begin_, this->capacity());
+    begin_ = buffer;
+    end_ = buffer + size;
+    capacity_end_ = buffer + capacity;
+  }
+
+  // New element is constructed before relocating the old ones, so `args` may
+  // refer to them.
+  template <class... Args>
+  T& emplace_back_reallocating(Args&&... args) {
+    const size_type n = grown_capacity();
+    const size_type old_size = size();
+    T* const buffer = allocate(n);
+    BASE_VARIANT_TRY {
+      ::new (static_cast<void*>(buffer + old_size))
+          T(std::forward<Args>(args)...);
+    } BASE_VARIANT_CATCH_ALL {
+      deallocate(buffer, n);
+      BASE_VARIANT_RETHROW;
+    }
+    BASE_VARIANT_TRY {
+      relocate(std::integral_constant<bool, trivially_relocatable>{}, begin_,
+               end_, buffer);
+    } BASE_VARIANT_CATCH_ALL {
+      buffer[old_size].~T();
+      deallocate(buffer, n);
+      BASE_VARIANT_RETHROW;
+    }
+    adopt(buffer, old_size + 1, n);
+    return buffer[old_size];
+  }
+
+  // Destroys the erased elements and slides the tail bytes over them.
+  void erase_impl(std::true_type, T* first, T* last) noexcept {
+    destroy(first, last);
+    std::memmove(static_cast<void*>(first), static_cast<const void*>(last),
+                 (end_ - last) * sizeof(T));
+    end_ -= last - first;
+  }
+
+  void erase_impl(std::false_type, T* first, T* last) {
+    T* const new_end = std::move(last, end_, first);
+    destroy(new_end, end_);
+    end_ = new_end;
+  }
+
+  T* begin_ = nullptr;
+  T* end_ = nullptr;
+  T* capacity_end_ = nullptr;
+};
+
+template <class T>
+struct is_trivially_relocatable<relocating_vector<T>> : std::true_type {};
+
+}  // namespace base
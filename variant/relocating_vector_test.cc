@@ -0,0 +1,139 @@
+#include "relocating_vector.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "catch2/catch_all.hpp"
+#include "instrumented.h"
+#include "variant.h"
+
+namespace {
+
+using relocatable_t = base::testing::instrumented<int, true>;
+using movable_t = base::testing::instrumented<int, false>;
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+// Copied on reallocation, since its move may throw.
+struct throwing_move {
+  throwing_move(int value) : value(value) {}
+  throwing_move(const throwing_move& rhs) : value(rhs.value) {
+    if (value == 3) {
+      throw std::runtime_error{"throwing_move"};
+    }
+  }
+  throwing_move(throwing_move&& rhs) : value(rhs.value) {}
+
+  int value;
+};
+#endif
+
+}  // namespace
+
+namespace base {
+
+template <>
+struct is_trivially_relocatable<relocatable_t> : std::true_type {};
+
+}  // namespace base
+
+TEST_CASE("Trivially relocatable trait test", "[relocating_vector]") {
+  static_assert(base::is_trivially_relocatable_v<int>, "");
+  static_assert(base::is_trivially_relocatable_v<std::unique_ptr<int>>, "");
+  static_assert(!base::is_trivially_relocatable_v<std::string>, "");
+  static_assert(!base::is_trivially_relocatable_v<movable_t>, "");
+  static_assert(base::is_trivially_relocatable_v<
+                    base::variant<std::unique_ptr<int>, relocatable_t>>,
+                "");
+  static_assert(!base::is_trivially_relocatable_v<
+                    base::variant<std::unique_ptr<int>, std::string>>,
+                "");
+  static_assert(base::is_trivially_relocatable_v<
+                    base::relocating_vector<std::string>>,
+                "");
+}
+
+TEST_CASE("Relocating vector test", "[relocating_vector]") {
+  using var_t = base::variant<std::unique_ptr<int>, int>;
+  base::relocating_vector<var_t> v;
+  REQUIRE(v.empty());
+  for (int i = 0; i < 100; ++i) {
+    if (i % 2 == 0) {
+      v.emplace_back(std::make_unique<int>(i));
+    } else {
+      v.push_back(i);
+    }
+  }
+  REQUIRE(v.size() == 100);
+  REQUIRE(v.capacity() >= 100);
+  REQUIRE(*base::get<0>(v[98]) == 98);
+  REQUIRE(base::get<1>(v.back()) == 99);
+
+  // Erase slides the tail over the erased elements.
+  REQUIRE(v.erase(v.begin() + 10, v.begin() + 20) == v.begin() + 10);
+  REQUIRE(v.size() == 90);
+  REQUIRE(*base::get<0>(v[10]) == 20);
+  REQUIRE(v.erase(v.begin()) == v.begin());
+  REQUIRE(base::get<1>(v.front()) == 1);
+  v.pop_back();
+  REQUIRE(*base::get<0>(v.back()) == 98);
+
+  auto moved = std::move(v);
+  REQUIRE(v.empty());
+  REQUIRE(moved.size() == 88);
+  v.clear();
+  moved.clear();
+  REQUIRE(moved.empty());
+
+  base::relocating_vector<std::string> strings{"a", "b", "c"};
+  strings.push_back(strings.front());
+  auto copy = strings;
+  REQUIRE(copy == base::relocating_vector<std::string>{"a", "b", "c", "a"});
+  copy.erase(copy.begin() + 1);
+  REQUIRE(copy == base::relocating_vector<std::string>{"a", "c", "a"});
+  REQUIRE(copy != strings);
+}
+
+TEST_CASE("Relocating vector operation counts test", "[relocating_vector]") {
+  SECTION("Trivially relocatable elements are not moved") {
+    base::relocating_vector<relocatable_t> v;
+    relocatable_t::reset();
+    for (int i = 0; i < 100; ++i) {
+      v.emplace_back(i);
+    }
+    v.erase(v.begin() + 50);
+    REQUIRE(relocatable_t::counts().moves == 0);
+    REQUIRE(relocatable_t::counts().move_assignments == 0);
+    REQUIRE(relocatable_t::counts().destructions == 1);
+    REQUIRE(v[50].value == 51);
+  }
+
+  SECTION("Other elements are moved and destroyed") {
+    base::relocating_vector<movable_t> v;
+    v.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+      v.emplace_back(i);
+    }
+    movable_t::reset();
+    v.emplace_back(4);
+    REQUIRE(movable_t::counts().moves == 4);
+    REQUIRE(movable_t::counts().destructions == 4);
+    v.erase(v.begin());
+    REQUIRE(movable_t::counts().move_assignments == 4);
+    REQUIRE(v[0].value == 1);
+  }
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  SECTION("Failed reallocation leaves the vector untouched") {
+    base::relocating_vector<throwing_move> v;
+    v.reserve(4);
+    for (int i = 0; i < 4; ++i) {
+      v.emplace_back(i);
+    }
+    REQUIRE_THROWS_AS(v.emplace_back(4), std::runtime_error);
+    REQUIRE(v.size() == 4);
+    REQUIRE(v.capacity() == 4);
+    REQUIRE(v[3].value == 3);
+  }
+#endif
+}
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "variant.h"
+
+namespace base {
+
+// Serialized data is structurally malformed: an out of range tag, a length
+// which doesn't fit or input truncated in the middle of a value. Payloads of
+// trivially copyable alternatives aren't checked (see `serializer`).
+class serialization_error : public std::exception {
+ public:
+  const char* what() const noexcept override { return "serialization_error"; }
+};
+
+// Serialized bytes being read front to back. Reads past the end raise
+// `serialization_error`.
+class serial_input {
+ public:
+  serial_input(const void* data, std::size_t size) noexcept
+      : pos_(static_cast<const unsigned char*>(data)), end_(pos_ + size) {}
+
+  bool empty() const noexcept { return pos_ == end_; }
+  const unsigned char* position() const noexcept { return pos_; }
+
+  // Returns the next `n` bytes and moves past them.
+  const unsigned char* take(std::size_t n) {
+    if (static_cast<std::size_t>(end_ - pos_) < n) {
+      detail::raise<serialization_error>();
+    }
+    const unsigned char* const result = pos_;
+    pos_ += n;
+    return result;
+  }
+
+  // Unsigned LEB128: 7 bits per byte, the high bit is set on all but the
+  // last byte.
+  std::uint64_t varint() {
+    std::uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      const unsigned char byte = *take(1);
+      result |= std::uint64_t{byte & 0x7fu} << shift;
+      if ((byte & 0x80) == 0) {
+        return result;
+      }
+    }
+    detail::raise<serialization_error>();
+  }
+
+ private:
+  const unsigned char* pos_;
+  const unsigned char* end_;
+};
+
+namespace detail {
+
+constexpr std::size_t varint_size(std::uint64_t value) noexcept {
+  std::size_t size = 1;
+  for (; value >= 0x80; value >>= 7) {
+    ++size;
+  }
+  return size;
+}
+
+inline unsigned char* write_varint(std::uint64_t value,
+                                   unsigned char* out) noexcept {
+  for (; value >= 0x80; value >>= 7) {
+    *out++ = static_cast<unsigned char>(value | 0x80);
+  }
+  *out++ = static_cast<unsigned char>(value);
+  return out;
+}
+
+// Reads the varint tag of a variant with `n` alternatives.
+template <std::size_t n>
+std::size_t read_variant_index(serial_input& in) {
+  const std::uint64_t index = in.varint();
+  if (index >= n) {
+    raise<serialization_error>();
+  }
+  return static_cast<std::size_t>(index);
+}
+
+// Empty classes take no bytes at all.
+template <class T>
+constexpr std::size_t raw_size = std::is_empty<T>::value ? 0 : sizeof(T);
+
+}  // namespace detail
+
+// Extension point: encoding of alternatives of type `T`. Specializations
+// provide
+//
+//   static std::size_t size(const T& value);  // encoded size in bytes
+//   static unsigned char* write(const T& value, unsigned char* out);
+//   static T read(serial_input& in);
+//   using view_type = ...;  // what visitors of serialized views get
+//   static view_type view(serial_input& in);
+//
+// `write` returns the end of the written bytes, `read` and `view` move `in`
+// past the value. Types whose values are all encoded with the same number of
+// bytes also declare `static constexpr std::size_t fixed_size`.
+template <class T, class = void>
+struct serializer;
+
+// Trivially copyable types (except pointers) are copied as raw bytes in the
+// native byte order, so the format is meant for processes on one machine.
+// The bytes are taken as they are: e.g. a `bool` or an enum read from
+// corrupted data may hold a value it can't represent, so only data written
+// by `serializer` itself should be read.
+template <class T>
+struct serializer<T, std::enable_if_t<std::is_trivially_copyable<T>::value &&
+                                      !std::is_pointer<T>::value &&
+                                      !detail::is_variant<T>::value>> {
+  using view_type = T;
+
+  static constexpr std::size_t fixed_size = detail::raw_size<T>;
+
+  static std::size_t size(const T&) noexcept { return fixed_size; }
+
+  static unsigned char* write(const T& value, unsigned char* out) noexcept {
+    std::memcpy(out, &value, fixed_size);
+    return out + fixed_size;
+  }
+
+  static T read(serial_input& in) {
+    std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+    std::memcpy(&storage, in.take(fixed_size), fixed_size);
+    return reinterpret_cast<const T&>(storage);
+  }
+
+  static view_type view(serial_input& in) { return read(in); }
+};
+
+// Characters of a serialized string, which point into the serialized buffer.
+struct serialized_string {
+  std::string str() const { return std::string(data, size); }
+
+  const char* data;
+  std::size_t size;
+};
+
+// Length as a varint followed by the characters.
+template <>
+struct serializer<std::string> {
+  using view_type = serialized_string;
+
+  static std::size_t size(const std::string& value) noexcept {
+    return detail::varint_size(value.size()) + value.size();
+  }
+
+  static unsigned char* write(const std::string& value,
+                              unsigned char* out) noexcept {
+    out = detail::write_varint(value.size(), out);
+    std::memcpy(out, value.data(), value.size());
+    return out + value.size();
+  }
+
+  static std::string read(serial_input& in) { return view(in).str(); }
+
+  static view_type view(serial_input& in) {
+    const std::uint64_t size = in.varint();
+    if (size > SIZE_MAX) {
+      detail::raise<serialization_error>();
+    }
+    const auto n = static_cast<std::size_t>(size);
+    return {reinterpret_cast<const char*>(in.take(n)), n};
+  }
+};
+
+template <class V>
+class serialized_view;
+
+template <class V>
+class serialized_records;
+
+// Serialized variant: index of the alternative as a varint tag followed by
+// the alternative. A valueless variant can't be serialized
+// (`bad_variant_access`).
+template <class... Ts>
+class serialized_view<variant<Ts...>> {
+ public:
+  // Parses the variant at the front of `in` and moves past it. The payload
+  // is only skipped: alternatives are read when visited.
+  explicit serialized_view(serial_input& in)
+      : index_(detail::read_variant_index<sizeof...(Ts)>(in)),
+        payload_(in.position()) {
+    detail::dispatch_index<void, sizeof...(Ts)>(index_, [&in](auto i) {
+      serializer_t<decltype(i)::value>::view(in);
+    });
+    size_ = static_cast<std::size_t>(in.position() - payload_);
+  }
+
+  std::size_t index() const noexcept { return index_; }
+
+  // Calls `f` with `serializer<T>::view_type` of the held alternative `T`
+  // read from the buffer in place. The results are converted to the one of
+  // the first alternative.
+  template <class F>
+  decltype(auto) visit(F&& f) const {
+    using R =
+        base::invoke_result_t<F&&, typename serializer_t<0>::view_type>;
+    return detail::dispatch_index<R, sizeof...(Ts)>(
+        index_, [this, &f](auto i) -> R {
+          serial_input in{payload_, size_};
+          return detail::invoke_r<R>::call(
+              std::forward<F>(f), serializer_t<decltype(i)::value>::view(in));
+        });
+  }
+
+  // Reads the variant out of the buffer.
+  variant<Ts...> materialize() const {
+    return detail::dispatch_index<variant<Ts...>, sizeof...(Ts)>(
+        index_, [this](auto i) {
+          serial_input in{payload_, size_};
+          return variant<Ts...>{in_place_index<decltype(i)::value>,
+                                serializer_t<decltype(i)::value>::read(in)};
+        });
+  }
+
+ private:
+  template <std::size_t I>
+  using serializer_t = serializer<detail::alternative_type_t<I, Ts...>>;
+
+  template <class>
+  friend class serialized_records;
+
+  serialized_view() noexcept : index_(0), payload_(nullptr), size_(0) {}
+
+  std::size_t index_;
+  const unsigned char* payload_;
+  std::size_t size_;
+};
+
+template <class... Ts>
+struct serializer<variant<Ts...>> {
+  using view_type = serialized_view<variant<Ts...>>;
+
+  static std::size_t size(const variant<Ts...>& v) {
+    return detail::varint_size(v.index()) +
+           base::visit<std::size_t>(
+               [](const auto& value) {
+                 return serializer<std::decay_t<decltype(value)>>::size(value);
+               },
+               v);
+  }
+
+  static unsigned char* write(const variant<Ts...>& v, unsigned char* out) {
+    return base::visit<unsigned char*>(
+        [out, &v](const auto& value) {
+          return serializer<std::decay_t<decltype(value)>>::write(
+              value, detail::write_varint(v.index(), out));
+        },
+        v);
+  }
+
+  static variant<Ts...> read(serial_input& in) {
+    return detail::dispatch_index<variant<Ts...>, sizeof...(Ts)>(
+        detail::read_variant_index<sizeof...(Ts)>(in), [&in](auto i) {
+          using T = detail::alternative_type_t<decltype(i)::value, Ts...>;
+          return variant<Ts...>{in_place_index<decltype(i)::value>,
+                                serializer<T>::read(in)};
+        });
+  }
+
+  static view_type view(serial_input& in) { return view_type{in}; }
+};
+
+// Appends serialized `v` to `out`.
+template <class... Ts>
+void serialize(const variant<Ts...>& v, std::vector<unsigned char>& out) {
+  using serializer_type = serializer<variant<Ts...>>;
+  const std::size_t offset = out.size();
+  out.resize(offset + serializer_type::size(v));
+  serializer_type::write(v, out.data() + offset);
+}
+
+// Reads a variant of type `V` from the front of `in` and moves past it.
+template <class V>
+V deserialize(serial_input& in) {
+  return serializer<V>::read(in);
+}
+
+namespace detail {
+
+template <class T, class = void>
+struct fixed_serialized_size {
+  static constexpr bool fixed = false;
+  static constexpr std::size_t value = 0;
+};
+
+template <class T>
+struct fixed_serialized_size<
+    T, base::void_t<decltype(serializer<T>::fixed_size)>> {
+  static constexpr bool fixed = true;
+  static constexpr std::size_t value = serializer<T>::fixed_size;
+};
+
+template <class V>
+struct max_fixed_serialized_size;
+
+// Largest serialized size of variant `V` if all of its alternatives have
+// fixed sizes, 0 otherwise.
+template <class... Ts>
+struct max_fixed_serialized_size<variant<Ts...>>
+    : std::integral_constant<
+          std::size_t,
+          base::conjunction_v<std::integral_constant<
+              bool, fixed_serialized_size<unboxed_t<Ts>>::fixed>...>
+              ? varint_size(sizeof...(Ts) - 1) +
+                    std::max({fixed_serialized_size<unboxed_t<Ts>>::value...})
+              : 0> {};
+
+template <class ForwardIt>
+unsigned char* write_range(ForwardIt first, ForwardIt last,
+                           unsigned char* out) {
+  using V = std::decay_t<decltype(*first)>;
+  for (; first != last; ++first) {
+    out = serializer<V>::write(*first, out);
+  }
+  return out;
+}
+
+}  // namespace detail
+
+// Appends serialized variants of `[first, last)` to `out` back to back.
+//
+// If every alternative has a fixed size, `out` is grown once for the largest
+// possible encoding of the range and shrunk afterwards, so each variant is a
+// tag and a single copy of its payload without any bookkeeping. Otherwise
+// the sizes are summed up in a separate pass first.
+//
+// Valueless variants raise `bad_variant_access` from the first pass, before
+// `out` is grown, so `out` is left unchanged.
+template <class ForwardIt>
+void serialize_range(ForwardIt first, ForwardIt last,
+                     std::vector<unsigned char>& out) {
+  using V = std::decay_t<decltype(*first)>;
+  constexpr std::size_t max_size = detail::max_fixed_serialized_size<V>::value;
+  const std::size_t offset = out.size();
+  std::size_t size = 0;
+  if (max_size != 0) {
+    for (auto it = first; it != last; ++it) {
+      if (it->valueless_by_exception()) {
+        detail::raise<bad_variant_access>();
+      }
+      size += max_size;
+    }
+  } else {
+    for (auto it = first; it != last; ++it) {
+      size += serializer<V>::size(*it);
+    }
+  }
+  out.resize(offset + size);
+  unsigned char* const end =
+      detail::write_range(first, last, out.data() + offset);
+  out.resize(static_cast<std::size_t>(end - out.data()));
+}
+
+// Reads variants of type `V` until `in` is empty and writes them to `out`.
+template <class V, class OutputIt>
+OutputIt deserialize_range(serial_input& in, OutputIt out) {
+  for (; !in.empty(); ++out) {
+    *out = serializer<V>::read(in);
+  }
+  return out;
+}
+
+// Range of views of variants of type `V` serialized back to back, e.g. by
+// `serialize_range` into a memory-mapped file. Variants are parsed while
+// iterating and never materialized.
+template <class V>
+class serialized_records {
+ public:
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = serialized_view<V>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    reference operator*() const noexcept { return view_; }
+    pointer operator->() const noexcept { return &view_; }
+
+    iterator& operator++() {
+      parse();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) noexcept {
+      return a.record_ == b.record_;
+    }
+
+    friend bool operator!=(const iterator& a, const iterator& b) noexcept {
+      return !(a == b);
+    }
+
+   private:
+    friend class serialized_records;
+
+    explicit iterator(serial_input rest) : rest_(rest) { parse(); }
+
+    void parse() {
+      record_ = rest_.position();
+      if (!rest_.empty()) {
+        view_ = value_type{rest_};
+      }
+    }
+
+    serial_input rest_;
+    const unsigned char* record_;
+    value_type view_;
+  };
+
+  serialized_records(const void* data, std::size_t size) noexcept
+      : data_(data), size_(size) {}
+
+  iterator begin() const { return iterator{serial_input{data_, size_}}; }
+
+  iterator end() const {
+    return iterator{serial_input{
+        static_cast<const unsigned char*>(data_) + size_, 0}};
+  }
+
+ private:
+  const void* data_;
+  std::size_t size_;
+};
+
+}  // namespace base
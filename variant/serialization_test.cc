@@ -0,0 +1,255 @@
+#include "serialization.h"
+
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "test_util.h"
+
+namespace {
+
+struct point {
+  double x, y;
+};
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+// Trivially copyable, so it has a fixed size, but emplacing it from an int
+// throws and leaves the variant valueless.
+struct throw_on_int {
+  throw_on_int() = default;
+  explicit throw_on_int(int) { throw std::runtime_error{"throw_on_int"}; }
+
+  std::int32_t value = 0;
+};
+#endif
+
+// Not trivially copyable, serialized by the specialization below.
+struct name_list {
+  std::vector<std::string> names;
+};
+
+bool operator==(const name_list& a, const name_list& b) {
+  return a.names == b.names;
+}
+
+}  // namespace
+
+namespace base {
+
+// Count of names followed by the names.
+template <>
+struct serializer<name_list> {
+  using view_type = std::size_t;
+
+  static std::size_t size(const name_list& value) {
+    std::size_t result = detail::varint_size(value.names.size());
+    for (const auto& name : value.names) {
+      result += serializer<std::string>::size(name);
+    }
+    return result;
+  }
+
+  static unsigned char* write(const name_list& value, unsigned char* out) {
+    out = detail::write_varint(value.names.size(), out);
+    for (const auto& name : value.names) {
+      out = serializer<std::string>::write(name, out);
+    }
+    return out;
+  }
+
+  static name_list read(serial_input& in) {
+    name_list result;
+    result.names.resize(static_cast<std::size_t>(in.varint()));
+    for (auto& name : result.names) {
+      name = serializer<std::string>::read(in);
+    }
+    return result;
+  }
+
+  // Views only tell the number of names.
+  static view_type view(serial_input& in) {
+    const auto count = static_cast<std::size_t>(in.varint());
+    for (std::size_t i = 0; i < count; ++i) {
+      serializer<std::string>::view(in);
+    }
+    return count;
+  }
+};
+
+}  // namespace base
+
+namespace {
+
+using fixed_var_t = base::variant<std::int32_t, double, point, base::monostate>;
+using inner_t = base::variant<std::int64_t, std::string>;
+using var_t = base::variant<std::int32_t, std::string, inner_t, name_list>;
+
+template <class V>
+V round_trip(const V& v) {
+  std::vector<unsigned char> buffer;
+  base::serialize(v, buffer);
+  base::serial_input in{buffer.data(), buffer.size()};
+  V result = base::deserialize<V>(in);
+  REQUIRE(in.empty());
+  return result;
+}
+
+// Describes the views of `var_t` alternatives.
+struct view_printer {
+  std::string operator()(std::int32_t value) const {
+    return std::to_string(value);
+  }
+
+  std::string operator()(base::serialized_string value) const {
+    return '"' + value.str() + '"';
+  }
+
+  std::string operator()(const base::serialized_view<inner_t>& value) const {
+    return "inner" + std::to_string(value.index()) + ":" +
+           value.visit(*this);
+  }
+
+  std::string operator()(std::int64_t value) const {
+    return std::to_string(value) + "L";
+  }
+
+  std::string operator()(std::size_t count) const {
+    return std::to_string(count) + " names";
+  }
+};
+
+}  // namespace
+
+TEST_CASE("Serialization round trip") {
+  REQUIRE(base::get<std::int32_t>(round_trip(fixed_var_t{-7})) == -7);
+  REQUIRE(base::get<double>(round_trip(fixed_var_t{0.5})) == 0.5);
+  const point p = base::get<point>(round_trip(fixed_var_t{point{1.0, 2.0}}));
+  REQUIRE(p.x == 1.0);
+  REQUIRE(p.y == 2.0);
+  REQUIRE(round_trip(fixed_var_t{base::monostate{}}).index() == 3);
+
+  const std::string long_string(300, 'x');
+  REQUIRE(base::get<std::string>(round_trip(var_t{long_string})) ==
+          long_string);
+  REQUIRE(base::get<inner_t>(round_trip(var_t{inner_t{std::string{"in"}}})) ==
+          inner_t{std::string{"in"}});
+  const var_t names{name_list{{"a", "bc"}}};
+  REQUIRE(base::get<name_list>(round_trip(names)).names ==
+          std::vector<std::string>{"a", "bc"});
+}
+
+TEST_CASE("Serialization format") {
+  std::vector<unsigned char> buffer;
+  base::serialize(var_t{std::string{"ab"}}, buffer);
+  REQUIRE(buffer == std::vector<unsigned char>{1, 2, 'a', 'b'});
+
+  // Empty alternatives take only the tag.
+  buffer.clear();
+  base::serialize(fixed_var_t{base::monostate{}}, buffer);
+  REQUIRE(buffer == std::vector<unsigned char>{3});
+
+  // Multi-byte varint of the length.
+  buffer.clear();
+  base::serialize(var_t{std::string(200, 'x')}, buffer);
+  REQUIRE(buffer.size() == 1 + 2 + 200);
+  REQUIRE(buffer[1] == ((200 & 0x7f) | 0x80));
+  REQUIRE(buffer[2] == 200 >> 7);
+}
+
+TEST_CASE("Serialization errors") {
+  std::vector<unsigned char> buffer;
+  base::serialize(var_t{std::string{"abc"}}, buffer);
+
+  for (std::size_t size = 0; size < buffer.size(); ++size) {
+    base::serial_input in{buffer.data(), size};
+    REQUIRE_RAISES_AS(base::deserialize<var_t>(in), base::serialization_error);
+  }
+
+  const unsigned char bad_tag[] = {4};
+  base::serial_input in{bad_tag, sizeof(bad_tag)};
+  REQUIRE_RAISES_AS(base::serialized_view<var_t>{in},
+                    base::serialization_error);
+
+  const unsigned char endless_varint[11] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+                                            0x80, 0x80, 0x80, 0x80, 0x80};
+  base::serial_input endless{endless_varint, sizeof(endless_varint)};
+  REQUIRE_RAISES_AS(endless.varint(), base::serialization_error);
+}
+
+TEST_CASE("Serialized ranges and views") {
+  const std::vector<var_t> values = {
+      var_t{1}, var_t{std::string{"two"}}, var_t{inner_t{std::int64_t{3}}},
+      var_t{inner_t{std::string{"four"}}}, var_t{name_list{{"x", "y", "z"}}}};
+  std::vector<unsigned char> buffer{42};
+  base::serialize_range(values.begin(), values.end(), buffer);
+  REQUIRE(buffer[0] == 42);
+
+  std::vector<std::string> printed;
+  for (const auto& view : base::serialized_records<var_t>{
+           buffer.data() + 1, buffer.size() - 1}) {
+    printed.push_back(view.visit(view_printer{}));
+  }
+  REQUIRE(printed == std::vector<std::string>{"1", "\"two\"", "inner0:3L",
+                                              "inner1:\"four\"", "3 names"});
+
+  base::serial_input in{buffer.data() + 1, buffer.size() - 1};
+  std::vector<var_t> read;
+  base::deserialize_range<var_t>(in, std::back_inserter(read));
+  REQUIRE(read.size() == values.size());
+  REQUIRE(read[0] == values[0]);
+  REQUIRE(read[3] == values[3]);
+  REQUIRE(base::get<name_list>(read[4]).names.size() == 3);
+}
+
+TEST_CASE("Serialized range of fixed size alternatives") {
+  std::vector<fixed_var_t> values;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 3 == 0) {
+      values.emplace_back(point{double(i), -double(i)});
+    } else if (i % 3 == 1) {
+      values.emplace_back(std::int32_t{i});
+    } else {
+      values.emplace_back(base::monostate{});
+    }
+  }
+  std::vector<unsigned char> bulk;
+  base::serialize_range(values.begin(), values.end(), bulk);
+
+  std::vector<unsigned char> one_by_one;
+  for (const auto& v : values) {
+    base::serialize(v, one_by_one);
+  }
+  REQUIRE(bulk == one_by_one);
+
+  base::serial_input in{bulk.data(), bulk.size()};
+  std::vector<fixed_var_t> read(values.size());
+  base::deserialize_range<fixed_var_t>(in, read.begin());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    REQUIRE(read[i].index() == values[i].index());
+  }
+  REQUIRE(base::get<point>(read[99]).y == -99.0);
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Serialized range with a valueless variant") {
+  using throwing_var_t = base::variant<std::int32_t, throw_on_int>;
+  static_assert(
+      base::detail::max_fixed_serialized_size<throwing_var_t>::value != 0, "");
+
+  std::vector<throwing_var_t> values(5, throwing_var_t{std::int32_t{1}});
+  REQUIRE_THROWS_AS(values[2].emplace<1>(1), std::runtime_error);
+  REQUIRE(values[2].valueless_by_exception());
+
+  std::vector<unsigned char> buffer{42};
+  REQUIRE_THROWS_AS(base::serialize_range(values.begin(), values.end(), buffer),
+                    base::bad_variant_access);
+  REQUIRE(buffer == std::vector<unsigned char>{42});
+
+  values[2] = throw_on_int{};
+  base::serialize_range(values.begin(), values.end(), buffer);
+  REQUIRE(buffer.size() == 1 + 5 * (1 + sizeof(std::int32_t)));
+}
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+
+#include "out_of_line.h"
+#include "variant.h"
+
+namespace base {
+
+namespace detail {
+
+template <std::size_t capacity, class Alloc, class T>
+using inline_or_boxed_t =
+    std::conditional_t<(sizeof(T) <= capacity), T,
+                       out_of_line<T, typename std::allocator_traits<
+                                          Alloc>::template rebind_alloc<T>>>;
+
+}  // namespace detail
+
+// Variant keeping alternatives of at most `capacity` bytes inline and all the
+// larger ones in `out_of_line` boxes allocated with `Alloc`. Size of the whole
+// variant is therefore bounded by `max(capacity, sizeof(void*))` plus index,
+// regardless of the largest alternative.
+//
+// It's a plain `variant` of the stored types, and boxes are transparent for
+// `get`, `get_if`, `holds_alternative` and `visit`: `get<big>(v)` returns
+// `big&` for `v` of type `small_variant<8, double, big>`.
+//
+// Moving a boxed alternative steals the box, so the variant is nothrow move
+// constructible, but the moved-from variant may only be destroyed, copied or
+// assigned to (see `out_of_line`).
+template <std::size_t capacity, class Alloc, class... Ts>
+using basic_small_variant =
+    variant<detail::inline_or_boxed_t<capacity, Alloc, Ts>...>;
+
+template <std::size_t capacity, class... Ts>
+using small_variant =
+    basic_small_variant<capacity, std::allocator<void>, Ts...>;
+
+}  // namespace base
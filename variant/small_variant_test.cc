@@ -0,0 +1,233 @@
+#include "small_variant.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "test_util.h"
+
+namespace {
+
+struct big {
+  big() = default;
+  explicit big(int value) { data.fill(value); }
+
+  std::array<int, 64> data{};
+};
+
+bool operator==(const big& a, const big& b) { return a.data == b.data; }
+bool operator!=(const big& a, const big& b) { return a.data != b.data; }
+
+struct throw_on_construct {
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  throw_on_construct() { throw std::runtime_error{"throw_on_construct"}; }
+#endif
+
+  std::array<char, 64> data;
+};
+
+struct allocation_stats {
+  int allocations = 0;
+  int deallocations = 0;
+};
+
+template <class T>
+struct counting_allocator {
+  using value_type = T;
+
+  explicit counting_allocator(allocation_stats* stats) : stats(stats) {}
+
+  template <class U>
+  counting_allocator(const counting_allocator<U>& rhs) : stats(rhs.stats) {}
+
+  T* allocate(std::size_t n) {
+    ++stats->allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n) {
+    ++stats->deallocations;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  allocation_stats* stats;
+};
+
+template <class T, class U>
+bool operator==(const counting_allocator<T>& a,
+                const counting_allocator<U>& b) {
+  return a.stats == b.stats;
+}
+
+template <class T, class U>
+bool operator!=(const counting_allocator<T>& a,
+                const counting_allocator<U>& b) {
+  return a.stats != b.stats;
+}
+
+}  // namespace
+
+TEST_CASE("Small variant layout test", "[small_variant]") {
+  using var_t = base::small_variant<8, double, big>;
+
+  static_assert(std::is_same<var_t, base::variant<double, base::out_of_line<
+                                                              big>>>::value,
+                "");
+  static_assert(sizeof(base::out_of_line<big>) == sizeof(big*), "");
+  static_assert(sizeof(var_t) == 2 * sizeof(double), "");
+  static_assert(
+      std::is_same<base::variant_alternative_t<1, var_t>, big>::value, "");
+  // Moving a boxed alternative steals the box.
+  static_assert(std::is_nothrow_move_constructible<var_t>::value, "");
+  static_assert(std::is_nothrow_move_assignable<base::out_of_line<big>>::value,
+                "");
+
+  // Alternatives fitting into the capacity are kept inline.
+  static_assert(
+      std::is_same<base::small_variant<sizeof(big), double, big>,
+                   base::variant<double, big>>::value,
+      "");
+}
+
+TEST_CASE("Small variant access test", "[small_variant]") {
+  using var_t = base::small_variant<8, double, big>;
+
+  var_t v = big{1};
+  REQUIRE(v.index() == 1);
+  REQUIRE(base::holds_alternative<big>(v));
+  REQUIRE(base::get<big>(v) == big{1});
+  REQUIRE(base::get<1>(v).data[63] == 1);
+  REQUIRE(base::get_if<big>(&v) == &base::get<1>(v));
+  REQUIRE(base::get_if<double>(&v) == nullptr);
+  REQUIRE_RAISES_AS(base::get<double>(v), base::bad_variant_access);
+
+  auto visitor = [](const auto& value) -> std::string {
+    return std::is_same<std::decay_t<decltype(value)>, big>::value ? "big"
+                                                                    : "double";
+  };
+  REQUIRE(base::visit(visitor, v) == "big");
+
+  v = big{2};
+  REQUIRE(base::get<big>(v) == big{2});
+  v = 1.5;
+  REQUIRE(base::visit(visitor, v) == "double");
+  REQUIRE(base::get<double>(v) == 1.5);
+  v.emplace<big>(3);
+  REQUIRE(base::get<big>(v) == big{3});
+
+  const var_t a{base::in_place_type<big>, 4};
+  const var_t b{base::in_place_index<1>, 4};
+  REQUIRE(a == b);
+  REQUIRE(a != v);
+}
+
+TEST_CASE("Small variant ownership test", "[small_variant]") {
+  allocation_stats stats;
+  {
+    using var_t = base::basic_small_variant<8, counting_allocator<void>,
+                                            double, big, throw_on_construct>;
+    const counting_allocator<void> alloc{&stats};
+
+    var_t v{base::in_place_index<1>, std::allocator_arg, alloc, 1};
+    REQUIRE(stats.allocations == 1);
+
+    // Copies are deep.
+    var_t copy = v;
+    REQUIRE(stats.allocations == 2);
+    REQUIRE(&base::get<big>(copy) != &base::get<big>(v));
+    REQUIRE(base::get<big>(copy) == base::get<big>(v));
+
+    // Move construction steals the box, move assignment exchanges the boxes.
+    const big* value = &base::get<big>(copy);
+    var_t moved = std::move(copy);
+    REQUIRE(stats.allocations == 2);
+    REQUIRE(&base::get<big>(moved) == value);
+    var_t assigned{base::in_place_index<1>, std::allocator_arg, alloc, 2};
+    REQUIRE(stats.allocations == 3);
+    assigned = std::move(moved);
+    REQUIRE(stats.allocations == 3);
+    REQUIRE(&base::get<big>(assigned) == value);
+    REQUIRE(base::get<big>(moved) == big{2});
+    REQUIRE(&base::get<big>(moved) != value);
+
+    // Assignment of the same alternative reuses the allocation.
+    assigned = v;
+    REQUIRE(stats.allocations == 3);
+    REQUIRE(&base::get<big>(assigned) == value);
+
+    assigned = 1.0;
+    REQUIRE(stats.deallocations == 1);
+
+    // Growing a vector moves the boxes instead of copying them.
+    std::vector<var_t> values;
+    for (int i = 0; i < 10; ++i) {
+      values.emplace_back(base::in_place_index<1>, std::allocator_arg, alloc,
+                          i);
+    }
+    REQUIRE(stats.allocations == 13);
+    values.clear();
+    REQUIRE(stats.deallocations == 11);
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+    // Failed construction releases the memory and leaves variant valueless.
+    REQUIRE_THROWS_AS(v.emplace<2>(std::allocator_arg, alloc),
+                      std::runtime_error);
+    REQUIRE(v.valueless_by_exception());
+    REQUIRE(stats.allocations == 14);
+    REQUIRE(stats.deallocations == 13);
+#endif
+  }
+  REQUIRE(stats.allocations == stats.deallocations);
+}
+
+TEST_CASE("Small variant moved-from test", "[small_variant]") {
+  using var_t = base::small_variant<8, double, std::string, big>;
+
+  base::out_of_line<big> box{1};
+  base::out_of_line<big> moved_box = std::move(box);
+  REQUIRE(box.valueless_after_move());
+  REQUIRE(*moved_box == big{1});
+
+  // Copies of a moved-from box are moved-from too, and assignment gives it a
+  // value again.
+  base::out_of_line<big> box_copy = box;
+  REQUIRE(box_copy.valueless_after_move());
+  box_copy = moved_box;
+  REQUIRE(*box_copy == big{1});
+  box_copy = box;
+  REQUIRE(box_copy.valueless_after_move());
+  box = std::move(moved_box);
+  REQUIRE(*box == big{1});
+  REQUIRE(moved_box.valueless_after_move());
+
+  // Moved-from variant keeps its index and may be destroyed, copied or
+  // assigned to.
+  var_t source = big{1};
+  var_t moved = std::move(source);
+  REQUIRE(base::get<big>(moved) == big{1});
+  REQUIRE(source.index() == 2);
+  var_t copy = source;
+  REQUIRE(copy.index() == 2);
+  copy = moved;
+  REQUIRE(copy == moved);
+  source = big{2};
+  REQUIRE(base::get<big>(source) == big{2});
+  copy = std::move(source);
+  REQUIRE(base::get<big>(copy) == big{2});
+  source = 1.5;
+  REQUIRE(base::get<double>(source) == 1.5);
+
+  var_t text = std::string(100, 'x');
+  var_t moved_text = std::move(text);
+  REQUIRE(base::get<std::string>(moved_text).size() == 100);
+  var_t text_copy = text;
+  REQUIRE(base::holds_alternative<std::string>(text_copy));
+  text_copy = std::string{"z"};
+  REQUIRE(base::get<std::string>(text_copy) == "z");
+  text = std::string{"y"};
+  REQUIRE(base::get<std::string>(text) == "y");
+}
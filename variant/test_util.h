@@ -0,0 +1,159 @@
+#pragma once
+
+#include <csetjmp>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "variant.h"
+
+namespace base {
+
+namespace testing {
+
+struct raise_jump {
+  std::jmp_buf buffer;
+  const char* message = nullptr;
+};
+
+inline raise_jump& current_raise_jump() {
+  static raise_jump jump;
+  return jump;
+}
+
+[[noreturn]] inline void jump_back(const char* message) {
+  current_raise_jump().message = message;
+  std::longjmp(current_raise_jump().buffer, 1);
+}
+
+// Calls `f` and returns the description of the library error it raised: of
+// the thrown exception or of the one reported to the fatal error handler,
+// which then jumps back here. Only `f`'s frame may be skipped by the jump, so
+// it must not own anything. Empty if there was no error.
+template <class F>
+std::string raised_error(F f) {
+#if BASE_VARIANT_NO_EXCEPTIONS
+  const variant_error_handler previous = set_variant_error_handler(&jump_back);
+  current_raise_jump().message = nullptr;
+  if (setjmp(current_raise_jump().buffer) == 0) {
+    f();
+  }
+  set_variant_error_handler(previous);
+  const char* message = current_raise_jump().message;
+  return message != nullptr ? message : "";
+#else
+  try {
+    f();
+  } catch (const std::exception& e) {
+    return e.what();
+  }
+  return "";
+#endif
+}
+
+// Whether `f` raises a library error of type `E`. The type is only checked
+// when errors are exceptions, the handler gets just a description.
+template <class E, class F>
+bool raises(F f) {
+#if BASE_VARIANT_NO_EXCEPTIONS
+  return !raised_error(f).empty();
+#else
+  try {
+    f();
+  } catch (const E&) {
+    return true;
+  } catch (...) {
+  }
+  return false;
+#endif
+}
+
+// Alternative throwing from its move constructor, so emplacing it from a
+// temporary leaves the variant valueless. Without exceptions the move doesn't
+// throw, but it's still not `noexcept`.
+struct throw_on_move {
+  throw_on_move() = default;
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  throw_on_move(throw_on_move&&) { throw std::runtime_error{"throw_on_move"}; }
+#else
+  throw_on_move(throw_on_move&&) {}
+#endif
+  throw_on_move& operator=(throw_on_move&&) = default;
+};
+
+// Value made from `i`: `i` itself, its decimal string or a half of it.
+inline int mixed_value(std::size_t i, in_place_type_t<int>) {
+  return static_cast<int>(i);
+}
+
+inline std::string mixed_value(std::size_t i, in_place_type_t<std::string>) {
+  return std::to_string(i);
+}
+
+template <class T,
+          class = std::enable_if_t<std::is_floating_point<T>::value>>
+T mixed_value(std::size_t i, in_place_type_t<T>) {
+  return static_cast<T>(0.5 * i);
+}
+
+template <class V, std::size_t I>
+V make_mixed_alternative(std::size_t i) {
+  return V{in_place_index<I>,
+           mixed_value(i, in_place_type<variant_alternative_t<I, V>>)};
+}
+
+// `n` variants of three alternatives: element `i` holds alternative `i % 3`
+// made by `mixed_value(i)`, e.g. `0, "1", 1.0, 3, "4", 2.5` for
+// `variant<int, std::string, double>`.
+template <class Container>
+Container make_mixed_range(std::size_t n) {
+  using V = typename Container::value_type;
+  Container result;
+  result.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i % 3 == 0) {
+      result.push_back(make_mixed_alternative<V, 0>(i));
+    } else if (i % 3 == 1) {
+      result.push_back(make_mixed_alternative<V, 1>(i));
+    } else {
+      result.push_back(make_mixed_alternative<V, 2>(i));
+    }
+  }
+  return result;
+}
+
+// Names the alternatives of `variant<int, std::string, double>`.
+struct type_name {
+  std::string operator()(int) const { return "int"; }
+  std::string operator()(const std::string&) const { return "string"; }
+  std::string operator()(double) const { return "double"; }
+};
+
+// Tells the value category of the argument: 0 for lvalues, 1 for const
+// lvalues and 2 for rvalues.
+struct category {
+  template <class T>
+  int operator()(T&) const {
+    return 0;
+  }
+
+  template <class T>
+  int operator()(const T&) const {
+    return 1;
+  }
+
+  template <class T>
+  int operator()(T&&) const {
+    return 2;
+  }
+};
+
+}  // namespace testing
+
+}  // namespace base
+
+// `REQUIRE_THROWS_AS` for library errors, which works without exceptions too.
+#define REQUIRE_RAISES_AS(expr, E) \
+  REQUIRE(::base::testing::raises<E>([&] { static_cast<void>(expr); }))
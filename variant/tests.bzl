@@ -0,0 +1,20 @@
+"""Test rules of the variant package."""
+
+def variant_cc_test(name, srcs, copts, deps):
+    """Declares the `name` test and its `name_no_exceptions` twin.
+
+    The twin is built with -fno-exceptions, so library errors go to the fatal
+    error handler instead of being thrown.
+    """
+    native.cc_test(
+        name = name,
+        srcs = srcs,
+        copts = copts,
+        deps = deps,
+    )
+    native.cc_test(
+        name = name + "_no_exceptions",
+        srcs = srcs,
+        copts = copts + ["-fno-exceptions"],
+        deps = deps,
+    )
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "internal/variant_traits.h"
+
+namespace base {
+
+// Fixed size pool of threads running fork-join jobs with work stealing.
+//
+// `run(count, f)` splits tasks `[0, count)` into contiguous blocks, one per
+// worker queue, and blocks until all of them are done. Each worker takes tasks
+// from the front of its own queue and, once it's empty, steals from the back
+// of the others. The calling thread is worker 0, so a pool of size 1 has no
+// threads at all and runs everything inline.
+//
+// Jobs are serialized: concurrent `run` calls wait for each other. `run` must
+// not be called from inside a task of the same pool.
+class thread_pool {
+ public:
+  explicit thread_pool(std::size_t size = default_size()) {
+    size = std::max<std::size_t>(size, 1);
+    queues_.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      queues_.push_back(std::make_unique<task_queue>());
+    }
+    threads_.reserve(size - 1);
+    BASE_VARIANT_TRY {
+      for (std::size_t i = 1; i < size; ++i) {
+        threads_.emplace_back([this, i] { work(i); });
+      }
+    } BASE_VARIANT_CATCH_ALL {
+      stop();
+      BASE_VARIANT_RETHROW;
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() { stop(); }
+
+  // Number of workers including the calling thread.
+  std::size_t size() const noexcept { return queues_.size(); }
+
+  static std::size_t default_size() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  // Calls `f(task, worker)` for every `task` in `[0, count)`, where `worker`
+  // in `[0, size())` identifies the calling worker, so `f` may keep per-worker
+  // state without locking. If some call throws, the tasks not started yet are
+  // skipped and the first exception is rethrown.
+  template <class F>
+  void run(std::size_t count, F&& f) {
+    if (count == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> run_lock{run_mutex_};
+    auto job = job_impl<std::remove_reference_t<F>>{f};
+    job_ = &job;
+    error_ = nullptr;
+    failed_.store(false, std::memory_order_relaxed);
+    pending_.store(count, std::memory_order_relaxed);
+    const std::size_t block = (count + size() - 1) / size();
+    for (std::size_t i = 0; i < size(); ++i) {
+      const std::size_t last = std::min(count, (i + 1) * block);
+      std::lock_guard<std::mutex> lock{queues_[i]->mutex};
+      for (std::size_t task = i * block; task < last; ++task) {
+        queues_[i]->tasks.push_back(task);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      ++generation_;
+    }
+    wake_.notify_all();
+
+    run_tasks(0);
+    std::unique_lock<std::mutex> lock{mutex_};
+    done_.wait(lock, [this] {
+      return pending_.load(std::memory_order_acquire) == 0;
+    });
+    job_ = nullptr;
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  struct task_queue {
+    std::mutex mutex;
+    std::deque<std::size_t> tasks;
+  };
+
+  struct job {
+    virtual void call(std::size_t task, std::size_t worker) = 0;
+
+   protected:
+    ~job() = default;
+  };
+
+  template <class F>
+  struct job_impl final : job {
+    explicit job_impl(F& f) : f(f) {}
+
+    void call(std::size_t task, std::size_t worker) override {
+      f(task, worker);
+    }
+
+    F& f;
+  };
+
+  bool pop(std::size_t worker, std::size_t& task) {
+    for (std::size_t i = 0; i < size(); ++i) {
+      task_queue& queue = *queues_[(worker + i) % size()];
+      std::lock_guard<std::mutex> lock{queue.mutex};
+      if (!queue.tasks.empty()) {
+        if (i == 0) {
+          task = queue.tasks.front();
+          queue.tasks.pop_front();
+        } else {
+          task = queue.tasks.back();
+          queue.tasks.pop_back();
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run_tasks(std::size_t worker) {
+    std::size_t task;
+    while (pop(worker, task)) {
+      if (!failed_.load(std::memory_order_relaxed)) {
+        BASE_VARIANT_TRY {
+          job_->call(task, worker);
+        } BASE_VARIANT_CATCH_ALL {
+          std::lock_guard<std::mutex> lock{mutex_};
+          if (error_ == nullptr) {
+            error_ = std::current_exception();
+          }
+          failed_.store(true, std::memory_order_relaxed);
+        }
+      }
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        done_.notify_one();
+      }
+    }
+  }
+
+  void work(std::size_t worker) {
+    std::size_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock{mutex_};
+        wake_.wait(lock, [&] { return stopped_ || generation_ != seen; });
+        if (stopped_) {
+          return;
+        }
+        seen = generation_;
+      }
+      run_tasks(worker);
+    }
+  }
+
+  void stop() noexcept {
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stopped_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  std::vector<std::unique_ptr<task_queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex run_mutex_;
+  job* job_ = nullptr;
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<bool> failed_{false};
+  std::exception_ptr error_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::size_t generation_ = 0;
+  bool stopped_ = false;
+};
+
+// Process wide pool of `thread_pool::default_size()` workers, created on first
+// use.
+inline thread_pool& default_thread_pool() {
+  static thread_pool pool;
+  return pool;
+}
+
+}  // namespace base
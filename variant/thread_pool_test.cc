@@ -0,0 +1,53 @@
+#include "thread_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+
+TEST_CASE("Thread pool run test", "[thread_pool]") {
+  for (const std::size_t size : {1, 2, 4}) {
+    base::thread_pool pool{size};
+    REQUIRE(pool.size() == size);
+
+    for (const std::size_t count : {0, 1, 3, 1000}) {
+      std::vector<std::atomic<int>> calls(count);
+      std::vector<std::size_t> per_worker(size);
+      pool.run(count, [&](std::size_t task, std::size_t worker) {
+        ++calls[task];
+        ++per_worker[worker];
+      });
+      for (const auto& c : calls) {
+        REQUIRE(c == 1);
+      }
+      std::size_t total = 0;
+      for (const std::size_t n : per_worker) {
+        total += n;
+      }
+      REQUIRE(total == count);
+    }
+  }
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Thread pool exception test", "[thread_pool]") {
+  base::thread_pool pool{3};
+  std::atomic<int> calls{0};
+  REQUIRE_THROWS_AS(pool.run(100,
+                             [&](std::size_t task, std::size_t) {
+                               ++calls;
+                               if (task == 10) {
+                                 throw std::runtime_error{"task"};
+                               }
+                             }),
+                    std::runtime_error);
+  REQUIRE(calls >= 1);
+  REQUIRE(calls <= 100);
+
+  // The pool is still usable afterwards.
+  calls = 0;
+  pool.run(100, [&](std::size_t, std::size_t) { ++calls; });
+  REQUIRE(calls == 100);
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+
+#include "util/meta.h"
+
+namespace base {
+
+// Type is trivially relocatable, if moving an object to a new address and
+// destroying the source is equivalent to copying its bytes and forgetting the
+// source. Containers use `memcpy` to relocate such elements.
+//
+// Trivially copyable types qualify. Other types opt in by specializing the
+// trait; most of the types owning their resources through pointers do,
+// unlike the ones storing pointers into themselves (e.g. `std::string` with
+// small buffer).
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <class T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type {};
+
+template <class T, class D>
+struct is_trivially_relocatable<std::unique_ptr<T, D>>
+    : is_trivially_relocatable<D> {};
+
+}  // namespace base
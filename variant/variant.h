@@ -1,27 +1,17 @@
 #pragma once
 
-#include "internal/variant_traits.h"
+#include "internal/variant_hash.h"
+#include "internal/variant_storage.h"
+#include "trivially_relocatable.h"
 
 namespace base {
 
-template <class T>
-struct in_place_type_t {};
-
-template <class T>
-constexpr in_place_type_t<T> in_place_type;
-
-template <std::size_t I>
-struct in_place_index_t {};
-
-template <std::size_t I>
-constexpr in_place_index_t<I> in_place_index;
-
 template <std::size_t I, class V>
 struct variant_alternative;
 
 template <std::size_t I, class... Ts>
 struct variant_alternative<I, variant<Ts...>>
-    : base::type_pack_element<I, Ts...> {};
+    : detail::alternative_type<I, Ts...> {};
 
 template <std::size_t I, class V>
 using variant_alternative_t = typename variant_alternative<I, V>::type;
@@ -36,29 +26,40 @@ struct variant_size<variant<Ts...>>
 template <class V>
 constexpr std::size_t variant_size_v = variant_size<V>::value;
 
+// Variant holds nothing but the alternative and the index, so it's trivially
+// relocatable when all the alternatives are.
+template <class... Ts>
+struct is_trivially_relocatable<variant<Ts...>>
+    : base::conjunction<is_trivially_relocatable<Ts>...> {};
+
 constexpr std::size_t variant_npos = detail::variant_npos;
 
 template <class F, class... Vs,
           class Result = detail::visit_result_t<F&&, Vs&&...>>
 constexpr Result visit(F&& f, Vs&&... vs) {
-  constexpr auto matrixDimensionsSizes =
-      std::index_sequence<1 + variant_size_v<std::decay_t<Vs>>...>{};
+  return detail::visit<Result>(std::forward<F>(f), std::forward<Vs>(vs)...);
+}
 
-  return detail::visit<Result>(
-      std::forward<F>(f),
-      matops::build_all_matrix_indexes(matrixDimensionsSizes),
-      std::forward<Vs>(vs)...);
+// Same as above, but every handler result is implicitly converted to `R` (or
+// discarded if `R` is void). Handlers may return different types, and result
+// type isn't deduced over every combination of alternatives, which makes
+// large multi-variant visits much cheaper to compile.
+template <class R, class F, class... Vs>
+constexpr R visit(F&& f, Vs&&... vs) {
+  return detail::visit<R>(std::forward<F>(f), std::forward<Vs>(vs)...);
 }
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
 constexpr std::enable_if_t<index != variant_npos, bool> holds_alternative(
     const variant<Ts...>& v) noexcept {
   return index == v.index();
 }
 
 template <class... Ts>
-class variant {
+class variant : private detail::variant_base_t<Ts...> {
   using T_0 = variant_alternative_t<0, variant>;
+  using base_type = detail::variant_base_t<Ts...>;
 
   static_assert(base::conjunction_v<base::negation<std::is_reference<Ts>>...>,
                 "variant type arguments cannot be references.");
@@ -69,95 +70,41 @@ class variant {
   static_assert(sizeof...(Ts) > 0, "variant type list cannot be empty.");
 
  public:
-  variant() noexcept(std::is_nothrow_default_constructible<T_0>::value) {
+  // Copy/move constructors, assignments and destructor are provided by
+  // `base_type` and are trivial whenever they are trivial for all `Ts`.
+
+  constexpr variant() noexcept(
+      std::is_nothrow_default_constructible<T_0>::value)
+      : base_type(in_place_index<0>) {
     static_assert(std::is_default_constructible<T_0>::value,
                   "First alternative must be default constructible");
-    emplace_impl<0>();
-  }
-
-  variant(const variant& rhs) {
-    if (!rhs.valueless_by_exception()) {
-      forward_variant(rhs);
-    }
-  }
-
-  variant(variant&& rhs) noexcept(
-      base::conjunction_v<std::is_nothrow_move_constructible<Ts>...>) {
-    if (!rhs.valueless_by_exception()) {
-      forward_variant(std::move(rhs));
-    }
   }
 
   template <class T, class TDec = std::decay_t<T>,
-            std::size_t index = detail::index_of<TDec, Ts...>,
+            std::size_t index = detail::alternative_index<TDec, Ts...>,
             class = std::enable_if_t<!std::is_same<TDec, variant>::value &&
                                      index != variant_npos>>
-  variant(T&& value) {
-    emplace_impl<index>(std::forward<T>(value));
-  }
+  constexpr variant(T&& value)
+      : base_type(in_place_index<index>, std::forward<T>(value)) {}
 
   template <class T, class... Args>
-  explicit variant(in_place_type_t<T>, Args&&... args) {
-    emplace_impl<detail::index_of<std::decay_t<T>, Ts...>>(
-        std::forward<Args>(args)...);
-  }
+  constexpr explicit variant(in_place_type_t<T>, Args&&... args)
+      : base_type(
+            in_place_index<detail::alternative_index<std::decay_t<T>, Ts...>>,
+            std::forward<Args>(args)...) {}
 
   template <std::size_t I, class... Args>
-  explicit variant(in_place_index_t<I>, Args&&... args) {
-    emplace_impl<I>(std::forward<Args>(args)...);
-  }
-
-  ~variant() { destroy(); }
-
-  variant& operator=(const variant& rhs) {
-    if (rhs.valueless_by_exception()) {
-      if (!valueless_by_exception()) {
-        destroy_impl();
-        index_ = variant_npos;
-      }
-    } else if (index() == rhs.index()) {
-      visit(
-          [](auto& dst, const auto& src) {
-            detail::call_if_same<void>([](auto& x, const auto& y) { x = y; },
-                                       dst, src);
-          },
-          *this, rhs);
-    } else {
-      *this = variant{rhs};
-    }
-    return *this;
-  }
-
-  variant& operator=(variant&& rhs) {
-    if (rhs.valueless_by_exception()) {
-      if (!valueless_by_exception()) {
-        destroy_impl();
-        index_ = variant_npos;
-      }
-    } else if (index() == rhs.index()) {
-      visit(
-          [](auto& dst, auto& src) -> void {
-            detail::call_if_same<void>(
-                [](auto& x, auto& y) { x = std::move(y); }, dst, src);
-          },
-          *this, rhs);
-    } else {
-      destroy();
-      try {
-        forward_variant(std::move(rhs));
-      } catch (...) {
-        index_ = variant_npos;
-        throw;
-      }
-    }
-    return *this;
-  }
+  constexpr explicit variant(in_place_index_t<I>, Args&&... args)
+      : base_type(in_place_index<I>, std::forward<Args>(args)...) {}
 
   template <class T, class TDec = std::decay_t<T>>
   std::enable_if_t<!std::is_same<TDec, variant>::value, variant&> operator=(
       T&& value) {
     if (holds_alternative<TDec>(*this)) {
-      *reinterpret_as<detail::index_of<TDec, Ts...>>() = std::forward<T>(value);
+      // Boxed alternatives are assigned through the box, which may be empty
+      // after a move.
+      this->template alternative<detail::alternative_index<TDec, Ts...>>() =
+          std::forward<T>(value);
     } else {
       emplace<T>(std::forward<T>(value));
     }
@@ -166,100 +113,37 @@ class variant {
 
   // -------------------- OBSERVERS --------------------
 
-  constexpr std::size_t index() const noexcept { return index_; }
+  constexpr std::size_t index() const noexcept {
+    return static_cast<std::size_t>(this->index_) - 1;
+  }
 
   constexpr bool valueless_by_exception() const noexcept {
-    return index_ == variant_npos;
+    return this->is_valueless();
   }
 
   // -------------------- MODIFIERS --------------------
 
   template <std::size_t I, class... Args>
   std::enable_if_t<
-      std::is_constructible<variant_alternative_t<I, variant>, Args...>::value,
+      std::is_constructible<base::type_pack_element_t<I, Ts...>,
+                            Args...>::value,
       variant_alternative_t<I, variant>>&
   emplace(Args&&... args) {
-    destroy();
-    try {
-      return emplace_impl<I>(std::forward<Args>(args)...);
-    } catch (...) {
-      index_ = variant_npos;
-      throw;
-    }
+    return detail::unbox(
+        this->template replace<I>(std::forward<Args>(args)...));
   }
 
   template <class T, class... Args,
-            std::size_t index = detail::index_of<T, Ts...>>
+            std::size_t index = detail::alternative_index<T, Ts...>>
   auto emplace(Args&&... args)
       -> decltype(emplace<index>(std::forward<Args>(args)...)) {
     return emplace<index>(std::forward<Args>(args)...);
   }
 
-  void swap(variant& rhs) {
-    if (!valueless_by_exception() || !rhs.valueless_by_exception()) {
-      if (index() == rhs.index()) {
-        visit(
-            [](auto& a, auto& b) -> void {
-              detail::call_if_same<void>(
-                  [](auto& x, auto& y) { std::swap(x, y); }, a, b);
-            },
-            *this, rhs);
-      } else {
-        std::swap(*this, rhs);
-      }
-    }
-  }
-
- private:
-  void destroy() noexcept {
-    if (!valueless_by_exception()) {
-      destroy_impl();
-    }
-  }
-
-  void destroy_impl() noexcept {
-    visit(
-        [](auto& value) {
-          using T = std::decay_t<decltype(value)>;
-          value.~T();
-        },
-        *this);
-  }
-
-  template <std::size_t I, class... Args>
-  variant_alternative_t<I, variant>& emplace_impl(Args&&... args) {
-    new (&storage_)
-        variant_alternative_t<I, variant>(std::forward<Args>(args)...);
-    index_ = I;
-    return *reinterpret_as<I>();
-  }
-
-  template <class Variant>
-  void forward_variant(Variant&& rhs) {
-    visit(
-        [&](auto&& value) {
-          new (this) variant(std::forward<decltype(value)>(value));
-        },
-        std::forward<Variant>(rhs));
-  }
+  void swap(variant& rhs) { base_type::swap(rhs); }
 
  private:
   friend struct detail::variant_accessor;
-
-  template <std::size_t I>
-  variant_alternative_t<I, variant>* reinterpret_as() noexcept {
-    return reinterpret_cast<variant_alternative_t<I, variant>*>(&storage_);
-  }
-
-  template <std::size_t I>
-  const variant_alternative_t<I, variant>* reinterpret_as() const noexcept {
-    return reinterpret_cast<const variant_alternative_t<I, variant>*>(
-        &storage_);
-  }
-
- private:
-  std::size_t index_ = variant_npos;
-  std::aligned_union_t<0, Ts...> storage_;
 };
 
 template <class... Ts>
@@ -268,12 +152,8 @@ bool operator==(const variant<Ts...>& a, const variant<Ts...>& b) {
     return false;
   }
   return a.valueless_by_exception() ||
-         visit(
-             [](const auto& a, const auto& b) {
-               return detail::call_if_same<bool>(
-                   [](const auto& x, const auto& y) { return x == y; }, a, b);
-             },
-             a, b);
+         detail::visit_same<bool>(
+             [](const auto& x, const auto& y) { return x == y; }, a, b);
 }
 
 template <class... Ts>
@@ -284,12 +164,8 @@ bool operator!=(const variant<Ts...>& a, const variant<Ts...>& b) {
     return true;
   }
   return !a.valueless_by_exception() &&
-         visit(
-             [](const auto& a, const auto& b) {
-               return detail::call_if_same<bool>(
-                   [](const auto& x, const auto& y) { return x != y; }, a, b);
-             },
-             a, b);
+         detail::visit_same<bool>(
+             [](const auto& x, const auto& y) { return x != y; }, a, b);
 }
 
 template <class... Ts>
@@ -301,12 +177,8 @@ bool operator<(const variant<Ts...>& a, const variant<Ts...>& b) {
     return true;
   }
   if (a.index() == b.index()) {
-    return visit(
-        [](const auto& a, const auto& b) {
-          return detail::call_if_same<bool>(
-              [](const auto& x, const auto& y) { return x < y; }, a, b);
-        },
-        a, b);
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x < y; }, a, b);
   }
   return a.index() < b.index();
 }
@@ -322,12 +194,8 @@ bool operator>(const variant<Ts...>& a, const variant<Ts...>& b) {
     return true;
   }
   if (a.index() == b.index()) {
-    return visit(
-        [](const auto& a, const auto& b) -> bool {
-          return detail::call_if_same<bool>(
-              [](const auto& x, const auto& y) { return x > y; }, a, b);
-        },
-        a, b);
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x > y; }, a, b);
   }
   return a.index() > b.index();
 }
@@ -343,12 +211,8 @@ bool operator<=(const variant<Ts...>& a, const variant<Ts...>& b) {
     return false;
   }
   if (a.index() == b.index()) {
-    return visit(
-        [](const auto& a, const auto& b) {
-          return detail::call_if_same<bool>(
-              [](const auto& x, const auto& y) { return x <= y; }, a, b);
-        },
-        a, b);
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x <= y; }, a, b);
   }
   return a.index() < b.index();
 }
@@ -364,12 +228,8 @@ bool operator>=(const variant<Ts...>& a, const variant<Ts...>& b) {
     return false;
   }
   if (a.index() == b.index()) {
-    return visit(
-        [](const auto& a, const auto& b) {
-          return detail::call_if_same<bool>(
-              [](const auto& x, const auto& y) { return x >= y; }, a, b);
-        },
-        a, b);
+    return detail::visit_same<bool>(
+        [](const auto& x, const auto& y) { return x >= y; }, a, b);
   }
   return a.index() > b.index();
 }
@@ -377,9 +237,9 @@ bool operator>=(const variant<Ts...>& a, const variant<Ts...>& b) {
 namespace detail {
 
 template <std::size_t I, class V>
-decltype(auto) get_impl(V&& v) {
+constexpr decltype(auto) get_impl(V&& v) {
   if (I != v.index()) {
-    throw bad_variant_access{};
+    detail::raise<bad_variant_access>();
   }
   return detail::variant_accessor::get<I>(std::forward<V>(v));
 }
@@ -389,75 +249,123 @@ decltype(auto) get_impl(V&& v) {
 // -------------------- GET BY INDEX --------------------
 
 template <std::size_t I, class... Ts>
-base::type_pack_element_t<I, Ts...>& get(variant<Ts...>& v) {
+constexpr detail::alternative_type_t<I, Ts...>& get(variant<Ts...>& v) {
   return detail::get_impl<I>(v);
 }
 
 template <std::size_t I, class... Ts>
-const base::type_pack_element_t<I, Ts...>& get(const variant<Ts...>& v) {
+constexpr const detail::alternative_type_t<I, Ts...>& get(
+    const variant<Ts...>& v) {
   return detail::get_impl<I>(v);
 }
 
 template <std::size_t I, class... Ts>
-base::type_pack_element_t<I, Ts...>&& get(variant<Ts...>&& v) {
+constexpr detail::alternative_type_t<I, Ts...>&& get(variant<Ts...>&& v) {
   return detail::get_impl<I>(std::move(v));
 }
 
 template <std::size_t I, class... Ts>
-const base::type_pack_element_t<I, Ts...>&& get(const variant<Ts...>&& v) {
+constexpr const detail::alternative_type_t<I, Ts...>&& get(
+    const variant<Ts...>&& v) {
   return detail::get_impl<I>(std::move(v));
 }
 
 // -------------------- GET BY TYPE --------------------
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
-auto get(variant<Ts...>& v) -> decltype(get<index>(v)) {
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(variant<Ts...>& v) -> decltype(get<index>(v)) {
   return get<index>(v);
 }
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
-auto get(const variant<Ts...>& v) -> decltype(get<index>(v)) {
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(const variant<Ts...>& v) -> decltype(get<index>(v)) {
   return get<index>(v);
 }
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
-auto get(variant<Ts...>&& v) -> decltype(get<index>(std::move(v))) {
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(variant<Ts...>&& v) -> decltype(get<index>(std::move(v))) {
   return get<index>(std::move(v));
 }
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
-auto get(const variant<Ts...>&& v) -> decltype(get<index>(std::move(v))) {
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get(const variant<Ts...>&& v)
+    -> decltype(get<index>(std::move(v))) {
   return get<index>(std::move(v));
 }
 
 // -------------------- GET IF BY INDEX --------------------
 
 template <std::size_t I, class... Ts>
-std::add_pointer_t<base::type_pack_element_t<I, Ts...>> get_if(
+constexpr std::add_pointer_t<detail::alternative_type_t<I, Ts...>> get_if(
     variant<Ts...>* v) noexcept {
   return v != nullptr && I == v->index() ? &detail::variant_accessor::get<I>(*v)
                                          : nullptr;
 }
 
 template <std::size_t I, class... Ts>
-std::add_pointer_t<const base::type_pack_element_t<I, Ts...>> get_if(
-    const variant<Ts...>* v) noexcept {
+constexpr std::add_pointer_t<const detail::alternative_type_t<I, Ts...>>
+get_if(const variant<Ts...>* v) noexcept {
   return v != nullptr && I == v->index() ? &detail::variant_accessor::get<I>(*v)
                                          : nullptr;
 }
 
 // -------------------- GET IF BY TYPE --------------------
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
-auto get_if(variant<Ts...>* v) noexcept -> decltype(get_if<index>(v)) {
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get_if(variant<Ts...>* v) noexcept
+    -> decltype(get_if<index>(v)) {
   return get_if<index>(v);
 }
 
-template <class T, class... Ts, std::size_t index = detail::index_of<T, Ts...>>
-auto get_if(const variant<Ts...>* v) noexcept -> decltype(get_if<index>(v)) {
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto get_if(const variant<Ts...>* v) noexcept
+    -> decltype(get_if<index>(v)) {
   return get_if<index>(v);
 }
 
+// -------------------- TRY GET --------------------
+
+// Pointer to alternative `I` (`T`) of `v` or null if `v` holds another one,
+// same as `get_if(&v)`. Non-throwing replacement of `get` for the code built
+// without exceptions.
+template <std::size_t I, class... Ts>
+constexpr std::add_pointer_t<detail::alternative_type_t<I, Ts...>> try_get(
+    variant<Ts...>& v) noexcept {
+  return get_if<I>(&v);
+}
+
+template <std::size_t I, class... Ts>
+constexpr std::add_pointer_t<const detail::alternative_type_t<I, Ts...>>
+try_get(const variant<Ts...>& v) noexcept {
+  return get_if<I>(&v);
+}
+
+template <std::size_t I, class... Ts>
+void try_get(const variant<Ts...>&&) = delete;
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto try_get(variant<Ts...>& v) noexcept
+    -> decltype(get_if<index>(&v)) {
+  return get_if<index>(&v);
+}
+
+template <class T, class... Ts,
+          std::size_t index = detail::alternative_index<T, Ts...>>
+constexpr auto try_get(const variant<Ts...>& v) noexcept
+    -> decltype(get_if<index>(&v)) {
+  return get_if<index>(&v);
+}
+
+template <class T, class... Ts>
+void try_get(const variant<Ts...>&&) = delete;
+
 struct monostate {};
 
 constexpr bool operator<(monostate, monostate) noexcept { return false; }
@@ -470,28 +378,106 @@ constexpr bool operator!=(monostate, monostate) noexcept { return false; }
 namespace detail {
 
 template <std::size_t I, class... Ts>
-base::type_pack_element_t<I, Ts...>& variant_accessor::get(variant<Ts...>& v) {
-  return *v.template reinterpret_as<I>();
+constexpr detail::alternative_type_t<I, Ts...>& variant_accessor::get(
+    variant<Ts...>& v) {
+  return detail::unbox(v.template alternative<I>());
 }
 
 template <std::size_t I, class... Ts>
-const base::type_pack_element_t<I, Ts...>& variant_accessor::get(
+constexpr const detail::alternative_type_t<I, Ts...>& variant_accessor::get(
     const variant<Ts...>& v) {
-  return *v.template reinterpret_as<I>();
+  return detail::unbox(v.template alternative<I>());
 }
 
 template <std::size_t I, class... Ts>
-base::type_pack_element_t<I, Ts...>&& variant_accessor::get(
+constexpr detail::alternative_type_t<I, Ts...>&& variant_accessor::get(
     variant<Ts...>&& v) {
-  return std::move(*v.template reinterpret_as<I>());
+  return std::move(detail::unbox(v.template alternative<I>()));
 }
 
 template <std::size_t I, class... Ts>
-const base::type_pack_element_t<I, Ts...>&& variant_accessor::get(
+constexpr const detail::alternative_type_t<I, Ts...>&& variant_accessor::get(
     const variant<Ts...>&& v) {
-  return std::move(*v.template reinterpret_as<I>());
+  return std::move(detail::unbox(v.template alternative<I>()));
 }
 
+template <class... Ts>
+const void* variant_accessor::data(const variant<Ts...>& v) noexcept {
+  return v.data();
+}
+
+// -------------------- HASH --------------------
+
+// Every alternative is hashed as raw bytes, so the active one is read without
+// any dispatch: only as many bytes of the storage as the alternative has are
+// copied, and none for the valueless variant.
+template <class... Ts>
+std::size_t hash_variant(std::true_type, const variant<Ts...>& v) noexcept {
+  const std::size_t stored_index = v.index() + 1;
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, variant_accessor::data(v),
+              bytewise_hash_sizes<Ts...>::value[stored_index]);
+  return combine_variant_hash(stored_index, bits);
+}
+
+template <class... Ts>
+std::size_t hash_variant(std::false_type, const variant<Ts...>& v) {
+  if (v.valueless_by_exception()) {
+    return combine_variant_hash(0, 0);
+  }
+  const std::uint64_t h = dispatch_index<std::uint64_t, sizeof...(Ts)>(
+      v.index(), [&v](auto i) {
+        const auto& value = variant_accessor::get<decltype(i)::value>(v);
+        return alternative_hash<std::decay_t<decltype(value)>>{}(value);
+      });
+  return combine_variant_hash(v.index() + 1, h);
+}
+
+// Hashes are equal for both ways, so the choice is up to the alternatives.
+template <class... Ts>
+std::size_t hash_variant(const variant<Ts...>& v) {
+  return hash_variant(
+      std::integral_constant<
+          bool, base::conjunction_v<std::integral_constant<
+                    bool, is_bytewise_hashable<Ts>>...>>{},
+      v);
+}
+
+template <bool enabled, class... Ts>
+struct variant_hash {
+  std::size_t operator()(const variant<Ts...>& v) const {
+    return hash_variant(v);
+  }
+};
+
+// Disabled like `std::hash` of a type without hash support.
+template <class... Ts>
+struct variant_hash<false, Ts...> {
+  variant_hash() = delete;
+  variant_hash(const variant_hash&) = delete;
+  variant_hash& operator=(const variant_hash&) = delete;
+};
+
 }  // namespace detail
 
 }  // namespace base
+
+namespace std {
+
+// Combines index with the hash of the active alternative. Enabled when
+// `std::hash` is enabled for every (unboxed) alternative.
+template <class... Ts>
+struct hash<base::variant<Ts...>>
+    : base::detail::variant_hash<
+          base::conjunction_v<base::detail::is_hash_enabled<
+              std::remove_const_t<base::detail::unboxed_t<Ts>>>...>,
+          Ts...> {};
+
+template <>
+struct hash<base::monostate> {
+  std::size_t operator()(base::monostate) const noexcept {
+    return static_cast<std::size_t>(0x6d6f6e6f73746174ULL);
+  }
+};
+
+}  // namespace std
@@ -0,0 +1,1464 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <variant>
+#endif
+
+#include "atomic_variant.h"
+#include "benchmark/benchmark.h"
+#include "hash_range.h"
+#include "instrumented.h"
+#include "packed_variant.h"
+#include "serialization.h"
+#include "small_variant.h"
+#include "variant.h"
+#include "variant_queue.h"
+#include "variant_vector.h"
+#include "visit_each.h"
+#include "visit_expect.h"
+
+namespace {
+
+// Same as `double`, but with user provided copy operations, so the variant
+// holding it goes through the per-element dispatch.
+struct non_trivial_double {
+  non_trivial_double(double value) : value(value) {}
+  non_trivial_double(const non_trivial_double& rhs) : value(rhs.value) {}
+  non_trivial_double& operator=(const non_trivial_double& rhs) {
+    value = rhs.value;
+    return *this;
+  }
+  ~non_trivial_double() {}
+
+  double value;
+};
+
+using trivial_var_t = base::variant<double, int, base::monostate>;
+using non_trivial_var_t =
+    base::variant<non_trivial_double, int, base::monostate>;
+
+template <class V>
+std::vector<V> make_vector(std::size_t n) {
+  auto result = std::vector<V>{};
+  result.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i % 3 == 0) {
+      result.emplace_back(base::in_place_index<0>, 1.0 * i);
+    } else if (i % 3 == 1) {
+      result.emplace_back(base::in_place_index<1>, static_cast<int>(i));
+    } else {
+      result.emplace_back(base::in_place_index<2>);
+    }
+  }
+  return result;
+}
+
+template <std::size_t I>
+struct alternative {
+  int value;
+};
+
+template <class Indexes>
+struct alternatives_variant;
+
+template <std::size_t... Is>
+struct alternatives_variant<std::index_sequence<Is...>> {
+  using type = base::variant<alternative<Is>...>;
+};
+
+template <std::size_t n>
+using alternatives_variant_t =
+    typename alternatives_variant<std::make_index_sequence<n>>::type;
+
+template <std::size_t I, class V>
+void emplace_nth(V& v, std::size_t i, int value) {
+  if (I == i) {
+    v.template emplace<I>(alternative<I>{value});
+  }
+}
+
+template <class V, std::size_t... Is>
+V make_nth(std::size_t i, int value, std::index_sequence<Is...>) {
+  V result;
+  const int dummy[] = {(emplace_nth<Is>(result, i, value), 0)...};
+  (void)dummy;
+  return result;
+}
+
+// Pseudo random alternatives, so branch predictor can't learn the pattern.
+template <std::size_t n>
+std::vector<alternatives_variant_t<n>> make_random_vector(std::size_t size) {
+  auto result = std::vector<alternatives_variant_t<n>>{};
+  result.reserve(size);
+  std::uint32_t state = 42;
+  for (std::size_t i = 0; i < size; ++i) {
+    state = state * 1664525u + 1013904223u;
+    result.push_back(make_nth<alternatives_variant_t<n>>(
+        (state >> 16) % n, static_cast<int>(i), std::make_index_sequence<n>{}));
+  }
+  return result;
+}
+
+template <std::size_t I>
+bool operator<(const alternative<I>& a, const alternative<I>& b) {
+  return a.value < b.value;
+}
+
+template <std::size_t I>
+bool operator==(const alternative<I>& a, const alternative<I>& b) {
+  return a.value == b.value;
+}
+
+struct sum_visitor {
+  template <std::size_t I>
+  int operator()(const alternative<I>& value) const {
+    return value.value + static_cast<int>(I);
+  }
+};
+
+}  // namespace
+
+template <std::size_t n>
+void BM_visit(benchmark::State& state) {
+  const auto values = make_random_vector<n>(1024);
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto& v : values) {
+      sum += base::visit(sum_visitor{}, v);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+struct sum3_visitor {
+  template <std::size_t I, std::size_t J, std::size_t K>
+  int operator()(const alternative<I>& a, const alternative<J>& b,
+                 const alternative<K>& c) const {
+    return a.value + b.value * c.value + static_cast<int>(I + J + K);
+  }
+};
+
+// 3-way visit, engine is chosen by BASE_VARIANT_NESTED_MULTI_VISIT.
+template <std::size_t n>
+void BM_visit3(benchmark::State& state) {
+  const auto values = make_random_vector<n>(1026);
+  for (auto _ : state) {
+    int sum = 0;
+    for (std::size_t i = 0; i + 2 < values.size(); ++i) {
+      sum += base::visit(sum3_visitor{}, values[i], values[i + 1],
+                         values[i + 2]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * (values.size() - 2));
+}
+
+template <std::size_t n>
+void BM_sort_unique(benchmark::State& state) {
+  const auto values = make_random_vector<n>(1024);
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto copy = values;
+    state.ResumeTiming();
+    std::sort(copy.begin(), copy.end());
+    copy.erase(std::unique(copy.begin(), copy.end()), copy.end());
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+struct large_value {
+  double values[32];
+};
+
+struct large_value_sum {
+  double operator()(double value) const { return value; }
+  double operator()(const large_value& value) const { return value.values[0]; }
+};
+
+// Inline storage takes `sizeof(large_value)` for every element, small variant
+// keeps doubles inline and large values on the heap.
+using inline_uneven_var_t = base::variant<double, large_value>;
+using small_uneven_var_t =
+    base::small_variant<sizeof(double), double, large_value>;
+
+// Fills a vector without `reserve` with variants, `state.range(0)` percents
+// of which hold `large_value`, so growth relocates every element already
+// stored. Variants which aren't nothrow move constructible are copied there,
+// which for boxed values means an allocation per element per growth.
+template <class V>
+void BM_uneven_growth(benchmark::State& state) {
+  constexpr std::size_t size = 1 << 12;
+  for (auto _ : state) {
+    auto values = std::vector<V>{};
+    std::uint32_t rng = 42;
+    for (std::size_t i = 0; i < size; ++i) {
+      rng = rng * 1664525u + 1013904223u;
+      if ((rng >> 16) % 100 < static_cast<std::uint32_t>(state.range(0))) {
+        values.emplace_back(large_value{{1.0 * i}});
+      } else {
+        values.emplace_back(1.0 * i);
+      }
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Iterates over variants, `state.range(0)` percents of which hold
+// `large_value`. Reports footprint including heap allocated values.
+template <class V>
+void BM_uneven_sizes(benchmark::State& state) {
+  constexpr std::size_t size = 1 << 16;
+  auto values = std::vector<V>{};
+  values.reserve(size);
+  std::size_t large_count = 0;
+  std::uint32_t rng = 42;
+  for (std::size_t i = 0; i < size; ++i) {
+    rng = rng * 1664525u + 1013904223u;
+    if ((rng >> 16) % 100 < static_cast<std::uint32_t>(state.range(0))) {
+      values.emplace_back(large_value{{1.0 * i}});
+      ++large_count;
+    } else {
+      values.emplace_back(1.0 * i);
+    }
+  }
+
+  for (auto _ : state) {
+    double sum = 0;
+    for (const auto& v : values) {
+      sum += base::visit(large_value_sum{}, v);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  const bool boxed = sizeof(V) < sizeof(large_value);
+  state.counters["bytes_per_element"] =
+      (sizeof(V) * size + (boxed ? large_count * sizeof(large_value) : 0)) /
+      static_cast<double>(size);
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+using pointer_var_t =
+    base::variant<const alternative<0>*, const alternative<1>*,
+                  const alternative<2>*, const alternative<3>*>;
+using packed_pointer_var_t =
+    base::packed_variant<const alternative<0>*, const alternative<1>*,
+                         const alternative<2>*, const alternative<3>*>;
+
+struct pointer_sum_visitor {
+  template <std::size_t I>
+  int operator()(const alternative<I>* value) const {
+    return value->value + static_cast<int>(I);
+  }
+};
+
+// Visits pointers to the pseudo random alternatives, i.e. tree edges.
+template <class V>
+void BM_pointer_visit(benchmark::State& state) {
+  const auto values = make_random_vector<4>(1 << 16);
+  auto pointers = std::vector<V>{};
+  pointers.reserve(values.size());
+  for (const auto& v : values) {
+    pointers.push_back(base::visit([](const auto& x) { return V{&x}; }, v));
+  }
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto& p : pointers) {
+      sum += base::visit(pointer_sum_visitor{}, p);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["bytes_per_element"] = sizeof(V);
+  state.SetItemsProcessed(state.iterations() * pointers.size());
+}
+
+using scalar_var_t = base::variant<int, float, double>;
+
+struct scalar_sum {
+  template <class T>
+  void operator()(T value) {
+    sum += static_cast<double>(value);
+  }
+
+  double sum = 0;
+};
+
+// Pseudo random ints and doubles, the only float is the last element.
+template <class Container>
+Container make_scalars(std::size_t size) {
+  auto result = Container{};
+  result.reserve(size);
+  std::uint32_t rng = 42;
+  for (std::size_t i = 0; i + 1 < size; ++i) {
+    rng = rng * 1664525u + 1013904223u;
+    if ((rng >> 16) % 2 == 0) {
+      result.push_back(static_cast<int>(i));
+    } else {
+      result.push_back(0.5 * i);
+    }
+  }
+  result.push_back(1.0f);
+  return result;
+}
+
+void BM_aos_sum(benchmark::State& state) {
+  const auto values = make_scalars<std::vector<scalar_var_t>>(1 << 20);
+  for (auto _ : state) {
+    auto sum = scalar_sum{};
+    for (const auto& v : values) {
+      base::visit(sum, v);
+    }
+    benchmark::DoNotOptimize(sum.sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_soa_sum(benchmark::State& state) {
+  const auto values =
+      make_scalars<base::variant_vector<int, float, double>>(1 << 20);
+  for (auto _ : state) {
+    auto sum = scalar_sum{};
+    values.for_each_alternative(sum);
+    benchmark::DoNotOptimize(sum.sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_aos_find(benchmark::State& state) {
+  const auto values = make_scalars<std::vector<scalar_var_t>>(1 << 20);
+  for (auto _ : state) {
+    auto it = std::find_if(values.begin(), values.end(), [](const auto& v) {
+      return base::holds_alternative<float>(v);
+    });
+    benchmark::DoNotOptimize(it);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_soa_find(benchmark::State& state) {
+  const auto values =
+      make_scalars<base::variant_vector<int, float, double>>(1 << 20);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(values.find_first<float>());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_soa_count(benchmark::State& state) {
+  const auto values =
+      make_scalars<base::variant_vector<int, float, double>>(1 << 20);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(values.count<int>(0, values.size()));
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+struct accumulate_visitor {
+  template <std::size_t I>
+  void operator()(const alternative<I>& value) {
+    sum += value.value + static_cast<int>(I);
+  }
+
+  int sum = 0;
+};
+
+// Ranges of `visit_each` benchmarks are windows of `state.range(0)` variants
+// taken in turn from a pool of random ones, so the branch predictor doesn't
+// see the same pattern on every iteration, as it wouldn't on fresh data.
+constexpr std::size_t visit_pool_size = 1 << 16;
+
+template <class T>
+struct window {
+  const T* begin() const { return first; }
+  const T* end() const { return first + size; }
+
+  const T* first;
+  std::size_t size;
+};
+
+template <class T>
+window<T> next_window(const std::vector<T>& pool, std::size_t size,
+                      std::size_t& start) {
+  const auto result = window<T>{pool.data() + start, size};
+  start = (start + size) % pool.size();
+  return result;
+}
+
+// Baseline for `visit_each`: one indirect dispatch per element.
+template <std::size_t n>
+void BM_visit_loop(benchmark::State& state) {
+  const auto pool = make_random_vector<n>(visit_pool_size);
+  const auto size = static_cast<std::size_t>(state.range(0));
+  std::size_t start = 0;
+  for (auto _ : state) {
+    auto sum = accumulate_visitor{};
+    for (const auto& v : next_window(pool, size, start)) {
+      base::visit(sum, v);
+    }
+    benchmark::DoNotOptimize(sum.sum);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <std::size_t n>
+void BM_visit_each(benchmark::State& state) {
+  const auto pool = make_random_vector<n>(visit_pool_size);
+  const auto size = static_cast<std::size_t>(state.range(0));
+  std::size_t start = 0;
+  for (auto _ : state) {
+    auto sum = accumulate_visitor{};
+    base::visit_each(next_window(pool, size, start), sum);
+    benchmark::DoNotOptimize(sum.sum);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <std::size_t n>
+void BM_transform_loop(benchmark::State& state) {
+  const auto pool = make_random_vector<n>(visit_pool_size);
+  const auto size = static_cast<std::size_t>(state.range(0));
+  auto results = std::vector<int>(size);
+  std::size_t start = 0;
+  for (auto _ : state) {
+    const auto values = next_window(pool, size, start);
+    for (std::size_t i = 0; i < size; ++i) {
+      results[i] = base::visit(sum_visitor{}, values.first[i]);
+    }
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <std::size_t n>
+void BM_visit_transform(benchmark::State& state) {
+  const auto pool = make_random_vector<n>(visit_pool_size);
+  const auto size = static_cast<std::size_t>(state.range(0));
+  auto results = std::vector<int>(size);
+  std::size_t start = 0;
+  for (auto _ : state) {
+    base::visit_transform(next_window(pool, size, start), results.begin(),
+                          sum_visitor{});
+    benchmark::DoNotOptimize(results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+using key_var_t =
+    base::variant<std::uint8_t, std::uint32_t, std::uint64_t, const void*>;
+
+std::vector<key_var_t> make_keys(std::size_t size) {
+  auto result = std::vector<key_var_t>{};
+  result.reserve(size);
+  std::uint32_t rng = 42;
+  for (std::size_t i = 0; i < size; ++i) {
+    rng = rng * 1664525u + 1013904223u;
+    switch ((rng >> 16) % 4) {
+      case 0:
+        result.emplace_back(static_cast<std::uint8_t>(i));
+        break;
+      case 1:
+        result.emplace_back(static_cast<std::uint32_t>(i));
+        break;
+      case 2:
+        result.emplace_back(std::uint64_t{i});
+        break;
+      default:
+        result.emplace_back(static_cast<const void*>(&result));
+    }
+  }
+  return result;
+}
+
+// Same hashes as `BM_hash_range`, but with a dispatch per element.
+void BM_hash_dispatch(benchmark::State& state) {
+  const auto keys = make_keys(1 << 16);
+  auto hashes = std::vector<std::size_t>(keys.size());
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      hashes[i] = base::detail::hash_variant(std::false_type{}, keys[i]);
+    }
+    benchmark::DoNotOptimize(hashes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+void BM_hash_range(benchmark::State& state) {
+  const auto keys = make_keys(1 << 16);
+  auto hashes = std::vector<std::size_t>(keys.size());
+  for (auto _ : state) {
+    base::hash_range(keys.begin(), keys.end(), hashes.begin());
+    benchmark::DoNotOptimize(hashes.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+using heavy_var_t = base::variant<std::string, std::vector<int>>;
+using counted_heavy_var_t =
+    base::variant<base::testing::instrumented<std::string>,
+                  base::testing::instrumented<std::vector<int>>>;
+// Nothrow copyable, but not trivially.
+using counted_array_var_t =
+    base::variant<base::testing::instrumented<std::array<int, 16>>,
+                  base::testing::instrumented<std::array<int, 8>>>;
+
+template <class V>
+std::pair<V, V> make_different_pair() {
+  return {V{base::in_place_index<0>}, V{base::in_place_index<1>}};
+}
+
+template <>
+std::pair<heavy_var_t, heavy_var_t> make_different_pair() {
+  return {heavy_var_t{std::string(64, 'x')},
+          heavy_var_t{std::vector<int>(16, 1)}};
+}
+
+template <>
+std::pair<counted_heavy_var_t, counted_heavy_var_t> make_different_pair() {
+  return {counted_heavy_var_t{base::in_place_index<0>, std::string(64, 'x')},
+          counted_heavy_var_t{base::in_place_index<1>, 16, 1}};
+}
+
+// Reports copies and moves of all the alternatives per iteration, if they are
+// instrumented.
+template <class V>
+struct operation_counters {
+  static void reset() {}
+  static void report(benchmark::State&) {}
+};
+
+template <class... Ts, bool... nothrow_copy>
+struct operation_counters<
+    base::variant<base::testing::instrumented<Ts, nothrow_copy>...>> {
+  static void reset() {
+    const int dummy[] = {
+        (base::testing::instrumented<Ts, nothrow_copy>::reset(), 0)...};
+    (void)dummy;
+  }
+
+  static void report(benchmark::State& state) {
+    int copies = 0;
+    int moves = 0;
+    const int dummy[] = {
+        (copies += base::testing::instrumented<Ts, nothrow_copy>::counts()
+                       .copies,
+         moves += base::testing::instrumented<Ts, nothrow_copy>::counts().moves,
+         0)...};
+    (void)dummy;
+    state.counters["copies"] =
+        benchmark::Counter(copies, benchmark::Counter::kAvgIterations);
+    state.counters["moves"] =
+        benchmark::Counter(moves, benchmark::Counter::kAvgIterations);
+  }
+};
+
+// Copy assignments switching between the alternatives, so every one of them
+// replaces the held alternative.
+template <class V>
+void BM_copy_assign(benchmark::State& state) {
+  const auto sources = make_different_pair<V>();
+  V target = sources.second;
+  operation_counters<V>::reset();
+  for (auto _ : state) {
+    target = sources.first;
+    target = sources.second;
+    benchmark::DoNotOptimize(target);
+  }
+  operation_counters<V>::report(state);
+}
+
+template <class V>
+void BM_swap(benchmark::State& state) {
+  auto values = make_different_pair<V>();
+  operation_counters<V>::reset();
+  for (auto _ : state) {
+    values.first.swap(values.second);
+    benchmark::DoNotOptimize(values);
+  }
+  operation_counters<V>::report(state);
+}
+
+// Shared variant guarded by a mutex, the baseline for `atomic_variant`.
+template <class... Ts>
+class locked_variant {
+ public:
+  using value_type = base::variant<Ts...>;
+
+  value_type load() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return value_;
+  }
+
+  void store(const value_type& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    value_ = value;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  value_type value_;
+};
+
+struct as_double {
+  template <class T>
+  double operator()(T value) const {
+    return static_cast<double>(value);
+  }
+
+  double operator()(base::monostate) const { return 0; }
+};
+
+// The calling thread loads and visits the shared value, while
+// `state.range(0)` more readers do the same and one writer keeps switching it
+// between the first two alternatives.
+template <class Shared>
+void BM_contended_load(benchmark::State& state) {
+  using V = typename Shared::value_type;
+  using T_0 = base::variant_alternative_t<0, V>;
+  using T_1 = base::variant_alternative_t<1, V>;
+
+  Shared shared;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  threads.emplace_back([&shared, &done] {
+    for (int i = 0; !done.load(std::memory_order_relaxed); ++i) {
+      shared.store(i % 2 == 0
+                       ? V{base::in_place_index<0>, static_cast<T_0>(i)}
+                       : V{base::in_place_index<1>, static_cast<T_1>(i)});
+    }
+  });
+  for (std::int64_t i = 0; i < state.range(0); ++i) {
+    threads.emplace_back([&shared, &done] {
+      while (!done.load(std::memory_order_relaxed)) {
+        benchmark::DoNotOptimize(base::visit(as_double{}, shared.load()));
+      }
+    });
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base::visit(as_double{}, shared.load()));
+  }
+
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+using locked_pair_t = locked_variant<std::int64_t, double, base::monostate>;
+using atomic_pair_t =
+    base::atomic_variant<std::int64_t, double, base::monostate>;
+using atomic_word_t = base::atomic_variant<std::int32_t, float>;
+
+// Message filled by its constructor, like the ones built by pipeline stages.
+struct large_message {
+  explicit large_message(std::int64_t seed) { bytes.fill(seed); }
+
+  std::array<std::int64_t, 32> bytes;
+};
+
+struct message_checksum {
+  std::int64_t operator()(std::int64_t value) const { return value; }
+  std::int64_t operator()(const large_message& value) const {
+    return value.bytes.front() + value.bytes.back();
+  }
+};
+
+// Current way of passing messages between stages: built, then moved into a
+// `std::deque` under a lock and moved out again. Same interface as the
+// lock-free queues.
+template <class... Ts>
+class locked_queue {
+ public:
+  explicit locked_queue(std::size_t capacity) : capacity_(capacity) {}
+
+  template <class T, class... Args>
+  bool try_emplace(Args&&... args) {
+    base::variant<Ts...> message{base::in_place_type<T>,
+                                 std::forward<Args>(args)...};
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (messages_.size() == capacity_) {
+      return false;
+    }
+    messages_.push_back(std::move(message));
+    return true;
+  }
+
+  template <class F>
+  bool try_visit(F&& f) {
+    base::variant<Ts...> message;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (messages_.empty()) {
+        return false;
+      }
+      message = std::move(messages_.front());
+      messages_.pop_front();
+    }
+    base::visit(std::forward<F>(f), message);
+    return true;
+  }
+
+ private:
+  const std::size_t capacity_;
+  std::mutex mutex_;
+  std::deque<base::variant<Ts...>> messages_;
+};
+
+using locked_message_queue_t = locked_queue<std::int64_t, large_message>;
+using spsc_message_queue_t =
+    base::spsc_variant_queue<std::int64_t, large_message>;
+using mpmc_message_queue_t =
+    base::mpmc_variant_queue<std::int64_t, large_message>;
+
+// Every `100 / large_percent`-th message or so is large, the rest are small.
+template <class Queue>
+bool try_emplace_message(Queue& queue, std::int64_t i, int large_percent) {
+  if ((i * 37) % 100 < large_percent) {
+    return queue.template try_emplace<large_message>(i);
+  }
+  return queue.template try_emplace<std::int64_t>(i);
+}
+
+template <class Queue, class F>
+void visit_message(Queue& queue, F&& f) {
+  while (!queue.try_visit(f)) {
+    std::this_thread::yield();
+  }
+}
+
+// One thread keeps producing messages with `state.range(0)` percent of large
+// ones, the calling thread consumes one per iteration.
+template <class Queue>
+void BM_queue_throughput(benchmark::State& state) {
+  const auto large_percent = static_cast<int>(state.range(0));
+  Queue queue{1024};
+  std::atomic<bool> done{false};
+  std::thread producer([&queue, &done, large_percent] {
+    for (std::int64_t i = 0; !done.load(std::memory_order_relaxed);) {
+      if (try_emplace_message(queue, i, large_percent)) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::int64_t sum = 0;
+  for (auto _ : state) {
+    visit_message(queue, [&sum](const auto& message) {
+      sum += message_checksum{}(message);
+    });
+  }
+  benchmark::DoNotOptimize(sum);
+
+  done = true;
+  producer.join();
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Round trip of a message to an echo thread and back through a pair of
+// queues.
+template <class Queue>
+void BM_queue_latency(benchmark::State& state) {
+  const auto large_percent = static_cast<int>(state.range(0));
+  Queue requests{64};
+  Queue responses{64};
+  std::atomic<bool> done{false};
+  std::thread echo([&] {
+    while (!done.load(std::memory_order_relaxed)) {
+      const bool visited = requests.try_visit([&responses](auto& message) {
+        using T = std::decay_t<decltype(message)>;
+        while (!responses.template try_emplace<T>(std::move(message))) {
+        }
+      });
+      if (!visited) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::int64_t i = 0;
+  std::int64_t sum = 0;
+  for (auto _ : state) {
+    try_emplace_message(requests, i++, large_percent);
+    visit_message(responses, [&sum](const auto& message) {
+      sum += message_checksum{}(message);
+    });
+  }
+  benchmark::DoNotOptimize(sum);
+
+  done = true;
+  echo.join();
+}
+
+// `percent` of the values hold alternative 0, the rest are random.
+template <std::size_t n>
+std::vector<alternatives_variant_t<n>> make_skewed_vector(std::size_t size,
+                                                          int percent) {
+  auto result = make_random_vector<n>(size);
+  std::uint32_t state = 7;
+  for (std::size_t i = 0; i < size; ++i) {
+    state = state * 1664525u + 1013904223u;
+    if (static_cast<int>((state >> 16) % 100) < percent) {
+      result[i].template emplace<0>(alternative<0>{static_cast<int>(i)});
+    }
+  }
+  return result;
+}
+
+template <std::size_t n>
+void BM_visit_skewed(benchmark::State& state) {
+  const auto values =
+      make_skewed_vector<n>(1024, static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto& v : values) {
+      sum += base::visit(sum_visitor{}, v);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+template <std::size_t n>
+void BM_visit_expect(benchmark::State& state) {
+  const auto values =
+      make_skewed_vector<n>(1024, static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    int sum = 0;
+    for (const auto& v : values) {
+      sum += base::visit_expect<alternative<0>>(sum_visitor{}, v);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+struct record_point {
+  double x, y, z;
+};
+
+using record_t = base::variant<std::int64_t, double, record_point>;
+
+struct record_sum {
+  double operator()(std::int64_t value) const {
+    return static_cast<double>(value);
+  }
+  double operator()(double value) const { return value; }
+  double operator()(const record_point& p) const { return p.x + p.y + p.z; }
+};
+
+std::vector<record_t> make_records(std::size_t size) {
+  auto result = std::vector<record_t>{};
+  result.reserve(size);
+  std::uint32_t state = 42;
+  for (std::size_t i = 0; i < size; ++i) {
+    state = state * 1664525u + 1013904223u;
+    const auto x = static_cast<double>(i);
+    switch ((state >> 16) % 3) {
+      case 0:
+        result.emplace_back(static_cast<std::int64_t>(i));
+        break;
+      case 1:
+        result.emplace_back(x);
+        break;
+      default:
+        result.emplace_back(record_point{x, x, x});
+    }
+  }
+  return result;
+}
+
+template <class T>
+void append_bytes(std::vector<unsigned char>& out, const T& value) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+constexpr std::size_t record_count = 1 << 20;
+
+// Baseline: what `serialize` replaces, a hand-written switch appending the
+// tag and the payload of every record.
+void BM_serialize_switch(benchmark::State& state) {
+  const auto records = make_records(record_count);
+  auto buffer = std::vector<unsigned char>{};
+  for (auto _ : state) {
+    buffer.clear();
+    for (const auto& r : records) {
+      buffer.push_back(static_cast<unsigned char>(r.index()));
+      switch (r.index()) {
+        case 0:
+          append_bytes(buffer, base::get<0>(r));
+          break;
+        case 1:
+          append_bytes(buffer, base::get<1>(r));
+          break;
+        default:
+          append_bytes(buffer, base::get<2>(r));
+      }
+    }
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void BM_serialize_each(benchmark::State& state) {
+  const auto records = make_records(record_count);
+  auto buffer = std::vector<unsigned char>{};
+  for (auto _ : state) {
+    buffer.clear();
+    for (const auto& r : records) {
+      base::serialize(r, buffer);
+    }
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void BM_serialize_range(benchmark::State& state) {
+  const auto records = make_records(record_count);
+  auto buffer = std::vector<unsigned char>{};
+  for (auto _ : state) {
+    buffer.clear();
+    base::serialize_range(records.begin(), records.end(), buffer);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void BM_deserialize_range(benchmark::State& state) {
+  const auto records = make_records(record_count);
+  auto buffer = std::vector<unsigned char>{};
+  base::serialize_range(records.begin(), records.end(), buffer);
+  auto read = std::vector<record_t>{};
+  read.reserve(records.size());
+  for (auto _ : state) {
+    read.clear();
+    auto in = base::serial_input{buffer.data(), buffer.size()};
+    base::deserialize_range<record_t>(in, std::back_inserter(read));
+    benchmark::DoNotOptimize(read.data());
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+// Reads the records in place through views, nothing is materialized.
+void BM_serialized_records_visit(benchmark::State& state) {
+  const auto records = make_records(record_count);
+  auto buffer = std::vector<unsigned char>{};
+  base::serialize_range(records.begin(), records.end(), buffer);
+  for (auto _ : state) {
+    double sum = 0;
+    for (const auto& view :
+         base::serialized_records<record_t>{buffer.data(), buffer.size()}) {
+      sum += view.visit(record_sum{});
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+template <class V>
+void BM_vector_growth(benchmark::State& state) {
+  const auto n = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    auto v = std::vector<V>{};
+    for (std::size_t i = 0; i < n; ++i) {
+      v.emplace_back(base::in_place_index<1>, static_cast<int>(i));
+    }
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <class V>
+void BM_vector_copy(benchmark::State& state) {
+  const auto source = make_vector<V>(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto copy = source;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(V));
+}
+
+// Core operations of `base::variant`, of `std::variant` when built as C++17
+// and of an equivalent class hierarchy with virtual dispatch. Every benchmark
+// works on 1024 values of `n` pseudo random alternatives of `size` bytes.
+namespace {
+
+constexpr std::size_t kSuiteValues = 1024;
+
+template <std::size_t I, std::size_t size>
+struct payload {
+  std::int64_t value;
+  std::array<char, size - sizeof(std::int64_t)> padding;
+};
+
+template <std::size_t I, std::size_t size>
+bool operator<(const payload<I, size>& a, const payload<I, size>& b) {
+  return a.value < b.value;
+}
+
+template <std::size_t I, std::size_t size>
+bool operator==(const payload<I, size>& a, const payload<I, size>& b) {
+  return a.value == b.value;
+}
+
+struct base_family {
+  template <class... Ts>
+  using variant = base::variant<Ts...>;
+
+  template <std::size_t I>
+  static constexpr base::in_place_index_t<I> in_place_index() {
+    return base::in_place_index<I>;
+  }
+
+  template <class F, class... Vs>
+  static decltype(auto) visit(F&& f, Vs&&... vs) {
+    return base::visit(std::forward<F>(f), std::forward<Vs>(vs)...);
+  }
+};
+
+#if __cplusplus >= 201703L
+struct std_family {
+  template <class... Ts>
+  using variant = std::variant<Ts...>;
+
+  template <std::size_t I>
+  static constexpr std::in_place_index_t<I> in_place_index() {
+    return std::in_place_index<I>;
+  }
+
+  template <class F, class... Vs>
+  static decltype(auto) visit(F&& f, Vs&&... vs) {
+    return std::visit(std::forward<F>(f), std::forward<Vs>(vs)...);
+  }
+};
+#endif
+
+template <class Family, std::size_t size, class Indexes>
+struct payload_variant;
+
+template <class Family, std::size_t size, std::size_t... Is>
+struct payload_variant<Family, size, std::index_sequence<Is...>> {
+  using type = typename Family::template variant<payload<Is, size>...>;
+
+  template <std::size_t I>
+  static type make_alternative(std::int64_t value) {
+    return type{Family::template in_place_index<I>(),
+                payload<I, size>{value, {}}};
+  }
+
+  static type make(std::size_t i, std::int64_t value) {
+    using factory = type (*)(std::int64_t);
+    static constexpr factory factories[] = {&make_alternative<Is>...};
+    return factories[i](value);
+  }
+};
+
+template <class Family, std::size_t n, std::size_t size>
+using payload_variant_t =
+    payload_variant<Family, size, std::make_index_sequence<n>>;
+
+// Same pseudo random sequence as `make_random_vector`.
+template <class Family, std::size_t n, std::size_t size>
+std::vector<typename payload_variant_t<Family, n, size>::type>
+make_payload_vector(std::uint32_t seed) {
+  std::vector<typename payload_variant_t<Family, n, size>::type> result;
+  result.reserve(kSuiteValues);
+  std::uint32_t state = seed;
+  for (std::size_t i = 0; i < kSuiteValues; ++i) {
+    state = state * 1664525u + 1013904223u;
+    result.push_back(payload_variant_t<Family, n, size>::make(
+        (state >> 16) % n, static_cast<std::int64_t>(i % 7)));
+  }
+  return result;
+}
+
+struct payload_sum {
+  template <class... Ps>
+  std::int64_t operator()(const Ps&... values) const {
+    std::int64_t result = 0;
+    const int dummy[] = {(result += values.value, 0)...};
+    (void)dummy;
+    return result;
+  }
+};
+
+// The virtual dispatch baseline: values are allocated one by one and
+// visiting is a virtual call.
+struct node {
+  virtual ~node() = default;
+  virtual std::unique_ptr<node> clone() const = 0;
+  virtual std::int64_t sum() const = 0;
+};
+
+template <std::size_t I, std::size_t size>
+struct payload_node final : node {
+  explicit payload_node(std::int64_t value) : data{value, {}} {}
+
+  std::unique_ptr<node> clone() const override {
+    return std::make_unique<payload_node>(*this);
+  }
+
+  std::int64_t sum() const override { return data.value; }
+
+  payload<I, size> data;
+};
+
+template <std::size_t I, std::size_t size>
+std::unique_ptr<node> make_payload_node(std::int64_t value) {
+  return std::make_unique<payload_node<I, size>>(value);
+}
+
+template <std::size_t size, std::size_t... Is>
+std::unique_ptr<node> make_node(std::size_t i, std::int64_t value,
+                                std::index_sequence<Is...>) {
+  using factory = std::unique_ptr<node> (*)(std::int64_t);
+  static constexpr factory factories[] = {&make_payload_node<Is, size>...};
+  return factories[i](value);
+}
+
+template <std::size_t n, std::size_t size>
+std::vector<std::unique_ptr<node>> make_node_vector(std::uint32_t seed) {
+  std::vector<std::unique_ptr<node>> result;
+  result.reserve(kSuiteValues);
+  std::uint32_t state = seed;
+  for (std::size_t i = 0; i < kSuiteValues; ++i) {
+    state = state * 1664525u + 1013904223u;
+    result.push_back(make_node<size>((state >> 16) % n,
+                                     static_cast<std::int64_t>(i % 7),
+                                     std::make_index_sequence<n>{}));
+  }
+  return result;
+}
+
+}  // namespace
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_construct(benchmark::State& state) {
+  using V = typename payload_variant_t<Family, n, size>::type;
+  std::vector<V> values;
+  values.reserve(kSuiteValues);
+  for (auto _ : state) {
+    values.clear();
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      values.emplace_back(Family::template in_place_index<n - 1>(),
+                          payload<n - 1, size>{std::int64_t(i), {}});
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_copy(benchmark::State& state) {
+  const auto source = make_payload_vector<Family, n, size>(42);
+  for (auto _ : state) {
+    auto copy = source;
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+// Targets hold other alternatives than the sources for 1 - 1/n of values.
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_copy_assign(benchmark::State& state) {
+  const auto a = make_payload_vector<Family, n, size>(42);
+  const auto b = make_payload_vector<Family, n, size>(43);
+  auto targets = a;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      targets[i] = b[i];
+    }
+    benchmark::ClobberMemory();
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      targets[i] = a[i];
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * kSuiteValues);
+}
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_emplace(benchmark::State& state) {
+  auto values = make_payload_vector<Family, n, size>(42);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      values[i].template emplace<0>(payload<0, size>{std::int64_t(i), {}});
+    }
+    benchmark::ClobberMemory();
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      values[i].template emplace<n - 1>(
+          payload<n - 1, size>{std::int64_t(i), {}});
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * kSuiteValues);
+}
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_compare(benchmark::State& state) {
+  const auto a = make_payload_vector<Family, n, size>(42);
+  const auto b = make_payload_vector<Family, n, size>(43);
+  for (auto _ : state) {
+    int count = 0;
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      count += a[i] == b[i];
+      count += a[i] < b[i];
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_visit1(benchmark::State& state) {
+  const auto values = make_payload_vector<Family, n, size>(42);
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    for (const auto& v : values) {
+      sum += Family::visit(payload_sum{}, v);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_visit2(benchmark::State& state) {
+  const auto a = make_payload_vector<Family, n, size>(42);
+  const auto b = make_payload_vector<Family, n, size>(43);
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      sum += Family::visit(payload_sum{}, a[i], b[i]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <class Family, std::size_t n, std::size_t size>
+void BM_variant_visit3(benchmark::State& state) {
+  const auto a = make_payload_vector<Family, n, size>(42);
+  const auto b = make_payload_vector<Family, n, size>(43);
+  const auto c = make_payload_vector<Family, n, size>(44);
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      sum += Family::visit(payload_sum{}, a[i], b[i], c[i]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <std::size_t n, std::size_t size>
+void BM_virtual_construct(benchmark::State& state) {
+  std::vector<std::unique_ptr<node>> values;
+  values.reserve(kSuiteValues);
+  for (auto _ : state) {
+    values.clear();
+    for (std::size_t i = 0; i < kSuiteValues; ++i) {
+      values.push_back(
+          std::make_unique<payload_node<n - 1, size>>(std::int64_t(i)));
+    }
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <std::size_t n, std::size_t size>
+void BM_virtual_copy(benchmark::State& state) {
+  const auto source = make_node_vector<n, size>(42);
+  for (auto _ : state) {
+    std::vector<std::unique_ptr<node>> copy;
+    copy.reserve(kSuiteValues);
+    for (const auto& value : source) {
+      copy.push_back(value->clone());
+    }
+    benchmark::DoNotOptimize(copy.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+template <std::size_t n, std::size_t size>
+void BM_virtual_visit1(benchmark::State& state) {
+  const auto values = make_node_vector<n, size>(42);
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    for (const auto& value : values) {
+      sum += value->sum();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kSuiteValues);
+}
+
+BENCHMARK_TEMPLATE(BM_vector_growth, trivial_var_t)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_vector_growth, non_trivial_var_t)
+    ->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_vector_copy, trivial_var_t)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_vector_copy, non_trivial_var_t)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_visit, 2);
+BENCHMARK_TEMPLATE(BM_visit, 4);
+BENCHMARK_TEMPLATE(BM_visit, 8);
+BENCHMARK_TEMPLATE(BM_visit, 15);
+BENCHMARK_TEMPLATE(BM_visit, 32);
+
+BENCHMARK_TEMPLATE(BM_visit3, 4);
+BENCHMARK_TEMPLATE(BM_visit3, 8);
+
+BENCHMARK_TEMPLATE(BM_sort_unique, 4);
+BENCHMARK_TEMPLATE(BM_sort_unique, 15);
+BENCHMARK_TEMPLATE(BM_sort_unique, 32);
+
+BENCHMARK_TEMPLATE(BM_uneven_sizes, inline_uneven_var_t)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(50);
+BENCHMARK_TEMPLATE(BM_uneven_sizes, small_uneven_var_t)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(50);
+
+BENCHMARK_TEMPLATE(BM_uneven_growth, inline_uneven_var_t)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(BM_uneven_growth, small_uneven_var_t)->Arg(10)->Arg(50);
+
+BENCHMARK_TEMPLATE(BM_pointer_visit, pointer_var_t);
+BENCHMARK_TEMPLATE(BM_pointer_visit, packed_pointer_var_t);
+
+BENCHMARK(BM_aos_sum);
+BENCHMARK(BM_soa_sum);
+BENCHMARK(BM_aos_find);
+BENCHMARK(BM_soa_find);
+BENCHMARK(BM_soa_count);
+
+BENCHMARK_TEMPLATE(BM_visit_loop, 4)->RangeMultiplier(2)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_visit_each, 4)->RangeMultiplier(2)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_visit_loop, 32)->RangeMultiplier(2)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_visit_each, 32)->RangeMultiplier(2)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_transform_loop, 8)
+    ->RangeMultiplier(2)
+    ->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_visit_transform, 8)
+    ->RangeMultiplier(2)
+    ->Range(8, 1 << 16);
+
+BENCHMARK(BM_hash_dispatch);
+BENCHMARK(BM_hash_range);
+
+BENCHMARK_TEMPLATE(BM_copy_assign, heavy_var_t);
+BENCHMARK_TEMPLATE(BM_copy_assign, counted_heavy_var_t);
+BENCHMARK_TEMPLATE(BM_copy_assign, counted_array_var_t);
+BENCHMARK_TEMPLATE(BM_swap, heavy_var_t);
+BENCHMARK_TEMPLATE(BM_swap, counted_heavy_var_t);
+BENCHMARK_TEMPLATE(BM_swap, counted_array_var_t);
+
+BENCHMARK_TEMPLATE(BM_contended_load, locked_pair_t)->DenseRange(0, 3);
+BENCHMARK_TEMPLATE(BM_contended_load, atomic_pair_t)->DenseRange(0, 3);
+BENCHMARK_TEMPLATE(BM_contended_load, atomic_word_t)->DenseRange(0, 3);
+
+BENCHMARK_TEMPLATE(BM_queue_throughput, locked_message_queue_t)
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50)
+    ->Arg(100);
+BENCHMARK_TEMPLATE(BM_queue_throughput, spsc_message_queue_t)
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50)
+    ->Arg(100);
+BENCHMARK_TEMPLATE(BM_queue_throughput, mpmc_message_queue_t)
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(50)
+    ->Arg(100);
+BENCHMARK_TEMPLATE(BM_queue_latency, locked_message_queue_t)
+    ->Arg(0)
+    ->Arg(100);
+BENCHMARK_TEMPLATE(BM_queue_latency, spsc_message_queue_t)->Arg(0)->Arg(100);
+BENCHMARK_TEMPLATE(BM_queue_latency, mpmc_message_queue_t)->Arg(0)->Arg(100);
+
+
+BENCHMARK_TEMPLATE(BM_visit_skewed, 8)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(BM_visit_expect, 8)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(BM_visit_skewed, 32)->Arg(50)->Arg(90)->Arg(99);
+BENCHMARK_TEMPLATE(BM_visit_expect, 32)->Arg(50)->Arg(90)->Arg(99);
+
+BENCHMARK(BM_serialize_switch);
+BENCHMARK(BM_serialize_each);
+BENCHMARK(BM_serialize_range);
+BENCHMARK(BM_deserialize_range);
+BENCHMARK(BM_serialized_records_visit);
+
+// 8 and 64 byte alternatives, `std::variant` only in C++17 builds.
+#if __cplusplus >= 201703L
+#define VARIANT_SUITE(name, n)                  \
+  BENCHMARK_TEMPLATE(name, base_family, n, 8);  \
+  BENCHMARK_TEMPLATE(name, std_family, n, 8);   \
+  BENCHMARK_TEMPLATE(name, base_family, n, 64); \
+  BENCHMARK_TEMPLATE(name, std_family, n, 64)
+#else
+#define VARIANT_SUITE(name, n)                 \
+  BENCHMARK_TEMPLATE(name, base_family, n, 8); \
+  BENCHMARK_TEMPLATE(name, base_family, n, 64)
+#endif
+
+#define VIRTUAL_SUITE(name, n)    \
+  BENCHMARK_TEMPLATE(name, n, 8); \
+  BENCHMARK_TEMPLATE(name, n, 64)
+
+VARIANT_SUITE(BM_variant_construct, 2);
+VARIANT_SUITE(BM_variant_construct, 8);
+VARIANT_SUITE(BM_variant_construct, 32);
+VIRTUAL_SUITE(BM_virtual_construct, 8);
+VARIANT_SUITE(BM_variant_copy, 2);
+VARIANT_SUITE(BM_variant_copy, 8);
+VARIANT_SUITE(BM_variant_copy, 32);
+VIRTUAL_SUITE(BM_virtual_copy, 2);
+VIRTUAL_SUITE(BM_virtual_copy, 8);
+VIRTUAL_SUITE(BM_virtual_copy, 32);
+VARIANT_SUITE(BM_variant_copy_assign, 2);
+VARIANT_SUITE(BM_variant_copy_assign, 8);
+VARIANT_SUITE(BM_variant_copy_assign, 32);
+VARIANT_SUITE(BM_variant_emplace, 2);
+VARIANT_SUITE(BM_variant_emplace, 8);
+VARIANT_SUITE(BM_variant_emplace, 32);
+VARIANT_SUITE(BM_variant_compare, 2);
+VARIANT_SUITE(BM_variant_compare, 8);
+VARIANT_SUITE(BM_variant_compare, 32);
+VARIANT_SUITE(BM_variant_visit1, 2);
+VARIANT_SUITE(BM_variant_visit1, 8);
+VARIANT_SUITE(BM_variant_visit1, 32);
+VIRTUAL_SUITE(BM_virtual_visit1, 2);
+VIRTUAL_SUITE(BM_virtual_visit1, 8);
+VIRTUAL_SUITE(BM_virtual_visit1, 32);
+VARIANT_SUITE(BM_variant_visit2, 2);
+VARIANT_SUITE(BM_variant_visit2, 8);
+VARIANT_SUITE(BM_variant_visit2, 32);
+VARIANT_SUITE(BM_variant_visit3, 2);
+VARIANT_SUITE(BM_variant_visit3, 8);
+
+BENCHMARK_MAIN();
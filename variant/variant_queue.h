@@ -0,0 +1,341 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "variant.h"
+
+namespace base {
+
+namespace detail {
+
+constexpr std::size_t cache_line_size = 64;
+
+constexpr std::size_t round_up_to_power_of_two(std::size_t n) noexcept {
+  std::size_t result = 1;
+  while (result < n) {
+    result *= 2;
+  }
+  return result;
+}
+
+// Uninitialized storage of a queued variant, padded to whole cache lines so
+// neighbouring messages are never written by different threads through the
+// same line.
+template <class V>
+struct alignas(cache_line_size) alignas(V) queue_slot {
+  V* get() noexcept { return reinterpret_cast<V*>(&storage); }
+
+  std::aligned_storage_t<sizeof(V), alignof(V)> storage;
+};
+
+// Slot of the multi-producer queue. `sequence` tells whose turn it is: the
+// slot is free for the producer of position `pos` when it's `pos` and ready
+// for the consumer of `pos` when it's `pos + 1`. `constructed` is false if
+// the producer's constructor threw and there is no message to consume.
+template <class V>
+struct alignas(cache_line_size) alignas(V) sequenced_queue_slot {
+  V* get() noexcept { return reinterpret_cast<V*>(&storage); }
+
+  std::atomic<std::size_t> sequence{0};
+  bool constructed = false;
+  std::aligned_storage_t<sizeof(V), alignof(V)> storage;
+};
+
+// Fixed size array of cache line aligned slots. Doesn't need over-aligned
+// `new`, so it works in C++14.
+template <class Slot>
+class slot_array {
+ public:
+  explicit slot_array(std::size_t size)
+      : buffer_(new unsigned char[size * sizeof(Slot) + alignof(Slot)]) {
+    void* first = buffer_.get();
+    std::size_t space = size * sizeof(Slot) + alignof(Slot);
+    slots_ = static_cast<Slot*>(
+        std::align(alignof(Slot), size * sizeof(Slot), first, space));
+    for (std::size_t i = 0; i < size; ++i) {
+      ::new (static_cast<void*>(slots_ + i)) Slot();
+    }
+  }
+
+  Slot& operator[](std::size_t i) noexcept { return slots_[i]; }
+
+ private:
+  static_assert(std::is_trivially_destructible<Slot>::value, "");
+
+  std::unique_ptr<unsigned char[]> buffer_;
+  Slot* slots_;
+};
+
+// Queue position on a cache line of its own.
+struct alignas(cache_line_size) queue_position {
+  std::atomic<std::size_t> value{0};
+};
+
+// Position owned by one side of a single-producer/single-consumer queue
+// together with that side's cached copy of the other position.
+struct alignas(cache_line_size) cached_queue_position {
+  std::atomic<std::size_t> value{0};
+  std::size_t cached_other = 0;
+};
+
+// Destroys the visited message even if the visitor throws.
+template <class V>
+struct message_guard {
+  ~message_guard() { message->~V(); }
+
+  V* message;
+};
+
+// Stores `value` into `target` on scope exit, so a slot is handed over even
+// if its visitor throws.
+struct release_guard {
+  ~release_guard() { target.store(value, std::memory_order_release); }
+
+  std::atomic<std::size_t>& target;
+  std::size_t value;
+};
+
+template <class V, class F>
+void visit_and_destroy(V* message, F&& f) {
+  const message_guard<V> guard{message};
+  base::visit(std::forward<F>(f), *message);
+}
+
+inline void queue_backoff() noexcept { std::this_thread::yield(); }
+
+}  // namespace detail
+
+// Bounded single-producer/single-consumer queue of `variant<Ts...>` messages.
+//
+// Messages are constructed directly in the queue slots by `emplace<T>` and
+// visited there by `visit`, then destroyed, so a message is never moved or
+// copied by the queue itself. Slots and both positions are cache line
+// aligned. Capacity is rounded up to a power of two.
+//
+// Exactly one thread may produce and one thread may consume at a time.
+template <class... Ts>
+class spsc_variant_queue {
+  using value_type = variant<Ts...>;
+  using slot_type = detail::queue_slot<value_type>;
+
+ public:
+  explicit spsc_variant_queue(std::size_t capacity)
+      : capacity_(detail::round_up_to_power_of_two(capacity)),
+        slots_(capacity_) {}
+
+  spsc_variant_queue(const spsc_variant_queue&) = delete;
+  spsc_variant_queue& operator=(const spsc_variant_queue&) = delete;
+
+  ~spsc_variant_queue() {
+    while (try_visit([](auto&&) {})) {
+    }
+  }
+
+  std::size_t capacity() const noexcept { return capacity_; }
+
+  // Constructs a `T` from `args` at the back of the queue, returns false if
+  // the queue is full. If the constructor throws, nothing is enqueued.
+  template <class T, class... Args,
+            std::size_t I = detail::alternative_index<T, Ts...>>
+  bool try_emplace(Args&&... args) {
+    const std::size_t head = head_.value.load(std::memory_order_relaxed);
+    if (full(head)) {
+      return false;
+    }
+    construct<I>(head, std::forward<Args>(args)...);
+    return true;
+  }
+
+  // Same as `try_emplace`, but waits while the queue is full.
+  template <class T, class... Args,
+            std::size_t I = detail::alternative_index<T, Ts...>>
+  void emplace(Args&&... args) {
+    const std::size_t head = head_.value.load(std::memory_order_relaxed);
+    while (full(head)) {
+      detail::queue_backoff();
+    }
+    construct<I>(head, std::forward<Args>(args)...);
+  }
+
+  // Visits the message at the front of the queue with `f` and destroys it,
+  // returns false if the queue is empty. `f` gets a non-const lvalue, so it
+  // may move the alternative out. The message is consumed even if `f` throws.
+  template <class F>
+  bool try_visit(F&& f) {
+    const std::size_t tail = tail_.value.load(std::memory_order_relaxed);
+    if (tail == tail_.cached_other) {
+      tail_.cached_other = head_.value.load(std::memory_order_acquire);
+      if (tail == tail_.cached_other) {
+        return false;
+      }
+    }
+    const detail::release_guard release{tail_.value, tail + 1};
+    detail::visit_and_destroy(slots_[tail & (capacity_ - 1)].get(),
+                              std::forward<F>(f));
+    return true;
+  }
+
+  // Same as `try_visit`, but waits while the queue is empty.
+  template <class F>
+  void visit(F&& f) {
+    while (!try_visit(f)) {
+      detail::queue_backoff();
+    }
+  }
+
+ private:
+  // Producer's cached copy of the consumer's position is refreshed only when
+  // the queue seems to be full, so the producer rarely reads the consumer's
+  // cache line. Same for the consumer.
+  bool full(std::size_t head) noexcept {
+    if (head - head_.cached_other != capacity_) {
+      return false;
+    }
+    head_.cached_other = tail_.value.load(std::memory_order_acquire);
+    return head - head_.cached_other == capacity_;
+  }
+
+  template <std::size_t I, class... Args>
+  void construct(std::size_t head, Args&&... args) {
+    ::new (static_cast<void*>(slots_[head & (capacity_ - 1)].get()))
+        value_type(in_place_index<I>, std::forward<Args>(args)...);
+    head_.value.store(head + 1, std::memory_order_release);
+  }
+
+  const std::size_t capacity_;
+  detail::slot_array<slot_type> slots_;
+  detail::cached_queue_position head_;
+  detail::cached_queue_position tail_;
+};
+
+// Bounded lock-free multi-producer/multi-consumer queue of `variant<Ts...>`
+// messages with the same interface as `spsc_variant_queue`.
+//
+// Every slot carries a sequence number, which producers and consumers of the
+// same position hand over to each other (D. Vyukov's bounded queue), so the
+// only contended writes are the increments of the shared positions.
+//
+// A producer holds up the consumers of its slot between claiming and
+// publishing it. If its constructor throws, the slot is still published, but
+// marked as empty and skipped by consumers.
+template <class... Ts>
+class mpmc_variant_queue {
+  using value_type = variant<Ts...>;
+  using slot_type = detail::sequenced_queue_slot<value_type>;
+
+ public:
+  explicit mpmc_variant_queue(std::size_t capacity)
+      : capacity_(detail::round_up_to_power_of_two(
+            capacity < 2 ? 2 : capacity)),
+        slots_(capacity_) {
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  mpmc_variant_queue(const mpmc_variant_queue&) = delete;
+  mpmc_variant_queue& operator=(const mpmc_variant_queue&) = delete;
+
+  ~mpmc_variant_queue() {
+    while (try_visit([](auto&&) {})) {
+    }
+  }
+
+  std::size_t capacity() const noexcept { return capacity_; }
+
+  template <class T, class... Args,
+            std::size_t I = detail::alternative_index<T, Ts...>>
+  bool try_emplace(Args&&... args) {
+    std::size_t pos;
+    slot_type* const slot = claim(head_, 0, pos);
+    if (slot == nullptr) {
+      return false;
+    }
+    construct<I>(slot, pos, std::forward<Args>(args)...);
+    return true;
+  }
+
+  template <class T, class... Args,
+            std::size_t I = detail::alternative_index<T, Ts...>>
+  void emplace(Args&&... args) {
+    std::size_t pos;
+    slot_type* slot;
+    while ((slot = claim(head_, 0, pos)) == nullptr) {
+      detail::queue_backoff();
+    }
+    construct<I>(slot, pos, std::forward<Args>(args)...);
+  }
+
+  template <class F>
+  bool try_visit(F&& f) {
+    std::size_t pos;
+    while (slot_type* const slot = claim(tail_, 1, pos)) {
+      // Hands the slot over to the producer of the next lap.
+      const detail::release_guard release{slot->sequence, pos + capacity_};
+      if (slot->constructed) {
+        detail::visit_and_destroy(slot->get(), std::forward<F>(f));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <class F>
+  void visit(F&& f) {
+    while (!try_visit(f)) {
+      detail::queue_backoff();
+    }
+  }
+
+ private:
+  // Advances `position` and returns the slot it pointed to, once the slot
+  // sequence reaches `pos + lag`: 0 for producers, 1 for consumers. Stores the
+  // claimed position in `pos`. Returns null if the queue is full (empty).
+  slot_type* claim(detail::queue_position& position, std::size_t lag,
+                   std::size_t& pos) noexcept {
+    pos = position.value.load(std::memory_order_relaxed);
+    for (;;) {
+      slot_type* const slot = &slots_[pos & (capacity_ - 1)];
+      const std::size_t sequence =
+          slot->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + lag));
+      if (diff == 0) {
+        if (position.value.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed)) {
+          return slot;
+        }
+      } else if (diff < 0) {
+        return nullptr;
+      } else {
+        pos = position.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  template <std::size_t I, class... Args>
+  void construct(slot_type* slot, std::size_t pos, Args&&... args) {
+    slot->constructed = false;
+    BASE_VARIANT_TRY {
+      ::new (static_cast<void*>(slot->get()))
+          value_type(in_place_index<I>, std::forward<Args>(args)...);
+      slot->constructed = true;
+    } BASE_VARIANT_CATCH_ALL {
+      slot->sequence.store(pos + 1, std::memory_order_release);
+      BASE_VARIANT_RETHROW;
+    }
+    slot->sequence.store(pos + 1, std::memory_order_release);
+  }
+
+  const std::size_t capacity_;
+  detail::slot_array<slot_type> slots_;
+  detail::queue_position head_;
+  detail::queue_position tail_;
+};
+
+}  // namespace base
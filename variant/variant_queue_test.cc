@@ -0,0 +1,197 @@
+#include "variant_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "instrumented.h"
+
+namespace {
+
+using counted_string = base::testing::instrumented<std::string>;
+
+static_assert(alignof(base::detail::queue_position) ==
+                  base::detail::cache_line_size,
+              "");
+static_assert(sizeof(base::detail::cached_queue_position) ==
+                  base::detail::cache_line_size,
+              "");
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+struct throw_on_construction {
+  explicit throw_on_construction(int) { throw std::runtime_error{"ctor"}; }
+};
+#endif
+
+template <class Queue>
+int pop_int(Queue& queue) {
+  int result = -1;
+  REQUIRE(queue.try_visit([&result](auto& value) { result = value; }));
+  return result;
+}
+
+// Simple FIFO semantics without any concurrency.
+template <template <class...> class Queue>
+void check_fifo() {
+  Queue<int, double> queue{3};
+  REQUIRE(queue.capacity() == 4);
+  REQUIRE_FALSE(queue.try_visit([](auto&) {}));
+
+  for (int lap = 0; lap < 3; ++lap) {
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(queue.template try_emplace<int>(i));
+    }
+    REQUIRE_FALSE(queue.template try_emplace<double>(1.0));
+    for (int i = 0; i < 4; ++i) {
+      REQUIRE(pop_int(queue) == i);
+    }
+    REQUIRE_FALSE(queue.try_visit([](auto&) {}));
+  }
+}
+
+struct string_reader {
+  void operator()(int) const {}
+  void operator()(const counted_string& value) const { *result = value.value; }
+
+  std::string* result;
+};
+
+// Messages are constructed in place, visited in place and destroyed once,
+// including the ones left in the queue.
+template <template <class...> class Queue>
+void check_in_place() {
+  counted_string::reset();
+  {
+    Queue<int, counted_string> queue{4};
+    queue.template emplace<counted_string>(3, 'x');
+    queue.template emplace<counted_string>("left");
+    std::string visited;
+    queue.visit(string_reader{&visited});
+    REQUIRE(visited == "xxx");
+  }
+  REQUIRE(counted_string::counts().copies == 0);
+  REQUIRE(counted_string::counts().moves == 0);
+  REQUIRE(counted_string::counts().destructions == 2);
+}
+
+struct to_int64 {
+  std::int64_t operator()(int value) const { return value; }
+  std::int64_t operator()(std::int64_t value) const { return value; }
+  std::int64_t operator()(const std::string& value) const {
+    return std::stoll(value);
+  }
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  std::int64_t operator()(const throw_on_construction&) const { return -1; }
+#endif
+};
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+template <template <class...> class Queue>
+void check_exceptions() {
+  Queue<std::string, throw_on_construction> queue{4};
+  REQUIRE_THROWS_AS(queue.template emplace<throw_on_construction>(1),
+                    std::runtime_error);
+  REQUIRE(queue.template try_emplace<std::string>("1"));
+  REQUIRE(queue.template try_emplace<std::string>("0"));
+
+  // A throwing visitor still consumes the message.
+  REQUIRE_THROWS_AS(queue.try_visit([](auto&) -> void {
+    throw std::runtime_error{"visit"};
+  }),
+                    std::runtime_error);
+  std::string result;
+  REQUIRE(queue.try_visit(
+      [&result](auto& value) { result = std::to_string(to_int64{}(value)); }));
+  REQUIRE(result == "0");
+  REQUIRE_FALSE(queue.try_visit([](auto&) {}));
+}
+#endif
+
+}  // namespace
+
+TEST_CASE("SPSC variant queue") {
+  check_fifo<base::spsc_variant_queue>();
+  check_in_place<base::spsc_variant_queue>();
+}
+
+TEST_CASE("MPMC variant queue") {
+  check_fifo<base::mpmc_variant_queue>();
+  check_in_place<base::mpmc_variant_queue>();
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Variant queue exceptions") {
+  check_exceptions<base::spsc_variant_queue>();
+  check_exceptions<base::mpmc_variant_queue>();
+}
+#endif
+
+TEST_CASE("SPSC variant queue keeps order across threads") {
+  constexpr int count = 100000;
+  base::spsc_variant_queue<int, std::string> queue{64};
+
+  std::thread producer([&queue] {
+    for (int i = 0; i < count; ++i) {
+      if (i % 3 == 0) {
+        queue.emplace<std::string>(std::to_string(i));
+      } else {
+        queue.emplace<int>(i);
+      }
+    }
+  });
+
+  int expected = 0;
+  bool ordered = true;
+  while (expected < count) {
+    queue.visit([&](auto& value) {
+      ordered = ordered && to_int64{}(value) == expected;
+      ++expected;
+    });
+  }
+  producer.join();
+  REQUIRE(ordered);
+}
+
+TEST_CASE("MPMC variant queue delivers every message once") {
+  constexpr int producers = 3;
+  constexpr int consumers = 3;
+  constexpr int per_producer = 20000;
+  base::mpmc_variant_queue<std::int64_t, std::string> queue{16};
+  std::atomic<std::int64_t> sum{0};
+  std::atomic<int> received{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue] {
+      for (int i = 1; i <= per_producer; ++i) {
+        if (i % 2 == 0) {
+          queue.emplace<std::string>(std::to_string(i));
+        } else {
+          queue.emplace<std::int64_t>(i);
+        }
+      }
+    });
+  }
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back([&] {
+      while (received.load() < producers * per_producer) {
+        const bool visited = queue.try_visit([&](auto& value) {
+          sum += to_int64{}(value);
+          ++received;
+        });
+        if (!visited) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const std::int64_t n = per_producer;
+  REQUIRE(sum.load() == producers * n * (n + 1) / 2);
+}
@@ -1,6 +1,15 @@
 #include "variant.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 #include "catch2/catch_all.hpp"
+#include "instrumented.h"
 
 TEST_CASE("Smoking test", "[variant]") {
   using var_t = base::variant<int, double, std::string>;
@@ -57,6 +66,8 @@ TEST_CASE("Smoking test", "[variant]") {
   }
 }
 
+// Without exceptions a variant can't become valueless.
+#if BASE_VARIANT_HAS_EXCEPTIONS
 TEST_CASE("Valueless by exception test", "[variant]") {
   struct TThrowOnConstruct {
     TThrowOnConstruct() { throw std::runtime_error{"TThrowOnConstruct"}; }
@@ -89,6 +100,7 @@ TEST_CASE("Valueless by exception test", "[variant]") {
     REQUIRE(base::holds_alternative<int>(v2));
   }
 }
+#endif
 
 namespace {
 
@@ -174,3 +186,400 @@ TEST_CASE("SFINAE-friendliness test", "[variant]") {
     REQUIRE(ILL_FORMED(var2_t, v, base::visit(notAllTypesOp, v)));
   }
 }
+
+namespace {
+
+template <std::size_t>
+struct tag {};
+
+template <class Indexes>
+struct tags_variant;
+
+template <std::size_t... Is>
+struct tags_variant<std::index_sequence<Is...>> {
+  using type = base::variant<tag<Is>...>;
+};
+
+}  // namespace
+
+TEST_CASE("Layout test", "[variant]") {
+  // Discriminator is the smallest unsigned type that fits `sizeof...(Ts) + 1`
+  // values, and it is placed after the storage.
+  static_assert(sizeof(base::variant<char>) == 2, "");
+  static_assert(sizeof(base::variant<char, short>) == 4, "");
+  static_assert(sizeof(base::variant<int, float>) == 8, "");
+  static_assert(sizeof(base::variant<double, int, void*>) == 16, "");
+  static_assert(alignof(base::variant<char, double>) == alignof(double), "");
+
+  struct big {
+    char data[255];
+  };
+  static_assert(sizeof(base::variant<big>) == 256, "");
+
+  // Variant of stateless alternatives is just its discriminator.
+  using wide_t = typename tags_variant<std::make_index_sequence<300>>::type;
+  static_assert(sizeof(wide_t) == sizeof(std::uint16_t), "");
+  static_assert(sizeof(base::variant<base::monostate, tag<0>, tag<1>>) == 1,
+                "");
+
+  wide_t w;
+  REQUIRE(0 == w.index());
+  w = tag<299>{};
+  REQUIRE(299 == w.index());
+  REQUIRE(base::holds_alternative<tag<299>>(w));
+
+  base::variant<char, short> v;
+  REQUIRE(0 == v.index());
+  REQUIRE(!v.valueless_by_exception());
+}
+
+TEST_CASE("Special members triviality test", "[variant]") {
+  using trivial_t = base::variant<double, int, base::monostate>;
+  static_assert(std::is_trivially_copyable<trivial_t>::value, "");
+  static_assert(std::is_trivially_destructible<trivial_t>::value, "");
+  static_assert(std::is_trivially_copy_constructible<trivial_t>::value, "");
+  static_assert(std::is_trivially_move_constructible<trivial_t>::value, "");
+  static_assert(std::is_trivially_copy_assignable<trivial_t>::value, "");
+  static_assert(std::is_trivially_move_assignable<trivial_t>::value, "");
+
+  using string_t = base::variant<int, std::string>;
+  static_assert(!std::is_trivially_destructible<string_t>::value, "");
+  static_assert(!std::is_trivially_copy_constructible<string_t>::value, "");
+  static_assert(std::is_copy_constructible<string_t>::value, "");
+  static_assert(std::is_nothrow_move_constructible<string_t>::value, "");
+
+  using unique_t = base::variant<int, std::unique_ptr<int>>;
+  static_assert(!std::is_copy_constructible<unique_t>::value, "");
+  static_assert(!std::is_copy_assignable<unique_t>::value, "");
+  static_assert(std::is_move_constructible<unique_t>::value, "");
+  static_assert(std::is_move_assignable<unique_t>::value, "");
+
+  trivial_t a = 1.5;
+  trivial_t b = a;
+  REQUIRE(base::get<double>(b) == 1.5);
+  b = 3;
+  a = b;
+  REQUIRE(base::get<int>(a) == 3);
+
+  unique_t u = std::make_unique<int>(5);
+  unique_t w = std::move(u);
+  REQUIRE(*base::get<1>(w) == 5);
+  u = 7;
+  w = std::move(u);
+  REQUIRE(base::get<int>(w) == 7);
+}
+
+namespace {
+
+struct constexpr_visitor {
+  constexpr int operator()(int value) const { return value * 2; }
+  constexpr int operator()(double value) const {
+    return static_cast<int>(value);
+  }
+  constexpr int operator()(char value) const { return value - 'a'; }
+};
+
+using literal_var_t = base::variant<int, double, char>;
+
+constexpr literal_var_t literal_values[] = {literal_var_t{21}, 3.5, 'e'};
+
+}  // namespace
+
+TEST_CASE("Constant expressions test", "[variant]") {
+  constexpr literal_var_t v;
+  static_assert(v.index() == 0, "");
+  static_assert(base::get<0>(v) == 0, "");
+
+  constexpr literal_var_t d{base::in_place_type<double>, 2.5};
+  static_assert(base::holds_alternative<double>(d), "");
+  static_assert(base::get<double>(d) == 2.5, "");
+  static_assert(*base::get_if<1>(&d) == 2.5, "");
+  static_assert(base::get_if<int>(&d) == nullptr, "");
+
+  constexpr literal_var_t copy = d;
+  static_assert(base::get<1>(copy) == 2.5, "");
+
+  static_assert(base::visit(constexpr_visitor{}, literal_values[0]) == 42, "");
+  static_assert(base::visit(constexpr_visitor{}, literal_values[1]) == 3, "");
+  static_assert(base::visit(constexpr_visitor{}, literal_values[2]) == 4, "");
+
+  REQUIRE(base::visit(constexpr_visitor{}, literal_values[0]) == 42);
+}
+
+TEST_CASE("Comparison test", "[variant]") {
+  using namespace std::string_literals;
+  using var_t = base::variant<int, std::string>;
+
+  REQUIRE(var_t{1} == var_t{1});
+  REQUIRE(var_t{1} != var_t{2});
+  REQUIRE(var_t{1} < var_t{2});
+  REQUIRE(var_t{2} > var_t{1});
+  REQUIRE(var_t{1} <= var_t{1});
+  REQUIRE(var_t{1} >= var_t{1});
+
+  // Alternatives with different indexes are ordered by index.
+  REQUIRE(var_t{100} < var_t{"a"s});
+  REQUIRE(var_t{"a"s} > var_t{100});
+  REQUIRE(var_t{100} != var_t{"a"s});
+
+  auto values = std::vector<var_t>{"b"s, 3, "a"s, 1, 2, "a"s};
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+  REQUIRE(values == std::vector<var_t>{1, 2, 3, "a"s, "b"s});
+
+  var_t a = "abc"s;
+  var_t b = "def"s;
+  a.swap(b);
+  REQUIRE(base::get<std::string>(a) == "def");
+  REQUIRE(base::get<std::string>(b) == "abc");
+}
+
+TEST_CASE("Multi visitation test", "[variant]") {
+  using var_t = base::variant<int, double, std::string>;
+
+  auto visitor = [](const auto& a, const auto& b, const auto& c) {
+    return std::to_string(sizeof(a)) + std::to_string(sizeof(b)) +
+           std::to_string(sizeof(c));
+  };
+
+  var_t a = 1;
+  var_t b = 2.0;
+  const var_t c = std::string{};
+  REQUIRE(base::visit(visitor, a, b, c) ==
+          std::to_string(sizeof(int)) + std::to_string(sizeof(double)) +
+              std::to_string(sizeof(std::string)));
+
+  base::visit(
+      [](auto& x, auto&& y) {
+        REQUIRE(std::is_same<decltype(x), int&>::value);
+        REQUIRE(std::is_same<decltype(y), double&&>::value);
+      },
+      a, std::move(b));
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  struct throw_on_construct {
+    throw_on_construct() { throw std::runtime_error{"throw_on_construct"}; }
+  };
+  base::variant<int, throw_on_construct> valueless;
+  REQUIRE_THROWS_AS(valueless.emplace<1>(), std::runtime_error);
+  REQUIRE_THROWS_AS(base::visit([](auto&&, auto&&) {}, a, valueless),
+                    base::bad_variant_access);
+#endif
+}
+
+namespace {
+
+struct tag_index {
+  template <std::size_t I>
+  std::size_t operator()(tag<I>) const {
+    return I;
+  }
+
+  template <std::size_t I, std::size_t J>
+  std::size_t operator()(tag<I>, tag<J>) const {
+    return I * 100 + J;
+  }
+};
+
+// Visits every alternative of a variant of `n` tags, alone and paired with
+// the last one.
+template <std::size_t... Is>
+bool visits_all_tags(std::index_sequence<Is...>) {
+  using var_t = typename tags_variant<std::index_sequence<Is...>>::type;
+  const std::size_t n = sizeof...(Is);
+  const var_t last{base::in_place_index<n - 1>};
+  const bool visited[] = {
+      (base::visit(tag_index{}, var_t{base::in_place_index<Is>}) == Is &&
+       base::visit(tag_index{}, var_t{base::in_place_index<Is>}, last) ==
+           Is * 100 + n - 1)...};
+  return std::all_of(std::begin(visited), std::end(visited),
+                     [](bool ok) { return ok; });
+}
+
+}  // namespace
+
+TEST_CASE("Dispatch size boundaries test", "[variant]") {
+  // Around `BASE_VARIANT_MAX_SWITCH_CASES` of every configuration, where the
+  // dispatch changes from `switch` to the table.
+  REQUIRE(visits_all_tags(std::make_index_sequence<1>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<2>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<15>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<16>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<17>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<31>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<32>{}));
+  REQUIRE(visits_all_tags(std::make_index_sequence<33>{}));
+}
+
+TEST_CASE("Explicit result visitation test", "[variant]") {
+  using var_t = base::variant<int, double, char>;
+
+  // Handlers return different types, all of them convertible to `double`.
+  auto twice = [](auto x) { return x + x; };
+  var_t v = 'a';
+  REQUIRE(base::visit<double>(twice, v) == 'a' + 'a');
+  v = 1.25;
+  REQUIRE(base::visit<double>(twice, v) == 2.5);
+
+  var_t a = 1;
+  var_t b = 'b';
+  REQUIRE(base::visit<long>([](auto x, auto y) { return x + y; }, a, b) ==
+          1 + 'b');
+
+  // Results are discarded when `R` is void.
+  int calls = 0;
+  base::visit<void>(
+      [&calls](auto x) {
+        ++calls;
+        return x;
+      },
+      v);
+  REQUIRE(calls == 1);
+
+  static_assert(base::visit<long>(constexpr_visitor{}, literal_values[0]) == 42,
+                "");
+}
+
+TEST_CASE("Stateless alternatives test", "[variant]") {
+  struct counted {
+    counted() = default;
+    explicit counted(int* constructions) { ++*constructions; }
+  };
+  using var_t = base::variant<base::monostate, tag<0>, counted>;
+  static_assert(sizeof(var_t) == 1, "");
+  static_assert(std::is_trivially_copyable<var_t>::value, "");
+  constexpr var_t literal{base::in_place_index<1>};
+  static_assert(literal.index() == 1, "");
+
+  int constructions = 0;
+  var_t v{base::in_place_index<2>, &constructions};
+  REQUIRE(constructions == 1);
+  REQUIRE(v.index() == 2);
+  v.emplace<counted>(&constructions);
+  REQUIRE(constructions == 2);
+
+  // All the variants share the instance of an alternative.
+  var_t copy = v;
+  REQUIRE(&base::get<counted>(copy) == &base::get<2>(v));
+  REQUIRE(base::get_if<tag<0>>(&v) == nullptr);
+
+  v = tag<0>{};
+  REQUIRE(base::holds_alternative<tag<0>>(v));
+  REQUIRE(base::visit([](auto value) { return sizeof(value); }, v) == 1);
+  REQUIRE(var_t{base::in_place_type<tag<0>>}.index() == 1);
+
+  // Alternatives with state are stored as usual.
+  static_assert(sizeof(base::variant<base::monostate, char>) == 2, "");
+}
+
+TEST_CASE("Hash test", "[variant]") {
+  struct no_hash {};
+  static_assert(
+      !std::is_default_constructible<
+          std::hash<base::variant<int, no_hash>>>::value,
+      "");
+  static_assert(
+      std::is_default_constructible<
+          std::hash<base::variant<int, std::string>>>::value,
+      "");
+
+  using var_t = base::variant<int, std::string, base::monostate>;
+  const auto hash = std::hash<var_t>{};
+  REQUIRE(hash(var_t{42}) == hash(var_t{42}));
+  REQUIRE(hash(var_t{std::string{"42"}}) == hash(var_t{std::string{"42"}}));
+  REQUIRE(hash(var_t{}) != hash(var_t{base::monostate{}}));
+
+  // Index takes part in the hash.
+  using same_t = base::variant<int, int>;
+  REQUIRE(std::hash<same_t>{}(same_t{base::in_place_index<0>, 1}) !=
+          std::hash<same_t>{}(same_t{base::in_place_index<1>, 1}));
+
+  // Equal values hash equally, even if their bytes differ.
+  using double_t = base::variant<double, int>;
+  REQUIRE(std::hash<double_t>{}(0.0) == std::hash<double_t>{}(-0.0));
+
+  // Only the bytes of the active alternative are hashed, so the ones left by
+  // a wider alternative don't matter.
+  using bytes_t = base::variant<char, std::uint64_t>;
+  bytes_t reused = ~std::uint64_t{0};
+  reused = 'a';
+  REQUIRE(std::hash<bytes_t>{}(reused) == std::hash<bytes_t>{}('a'));
+
+  std::unordered_set<var_t> keys{1, std::string{"one"}, 1, base::monostate{}};
+  REQUIRE(keys.size() == 3);
+  REQUIRE(keys.count(std::string{"one"}) == 1);
+}
+
+TEST_CASE("Operation counts test", "[variant]") {
+  // Both are nothrow movable, only the first one is nothrow copyable.
+  using nothrow_t = base::testing::instrumented<int, true>;
+  using throwing_t = base::testing::instrumented<int, false>;
+  using var_t = base::variant<nothrow_t, throwing_t>;
+  const auto reset = [] {
+    nothrow_t::reset();
+    throwing_t::reset();
+  };
+
+  SECTION("Copy assignment of nothrow copyable constructs in place") {
+    const var_t from{nothrow_t{1}};
+    var_t to{throwing_t{2}};
+    reset();
+    to = from;
+    REQUIRE(base::get<nothrow_t>(to).value == 1);
+    REQUIRE(nothrow_t::counts().copies == 1);
+    REQUIRE(nothrow_t::counts().moves == 0);
+    REQUIRE(throwing_t::counts().destructions == 1);
+  }
+
+  SECTION("Copy assignment of throwing copyable goes through a temporary") {
+    const var_t from{throwing_t{1}};
+    var_t to{nothrow_t{2}};
+    reset();
+    to = from;
+    REQUIRE(base::get<throwing_t>(to).value == 1);
+    REQUIRE(throwing_t::counts().copies == 1);
+    REQUIRE(throwing_t::counts().moves == 1);
+    REQUIRE(throwing_t::counts().destructions == 1);
+    REQUIRE(nothrow_t::counts().destructions == 1);
+  }
+
+  SECTION("Copy assignment of the same alternative") {
+    const var_t from{throwing_t{1}};
+    var_t to{throwing_t{2}};
+    reset();
+    to = from;
+    REQUIRE(throwing_t::counts().copy_assignments == 1);
+    REQUIRE(throwing_t::counts().copies == 0);
+  }
+
+  SECTION("Swap of different alternatives") {
+    var_t a{nothrow_t{1}};
+    var_t b{throwing_t{2}};
+    reset();
+    a.swap(b);
+    REQUIRE(base::get<throwing_t>(a).value == 2);
+    REQUIRE(base::get<nothrow_t>(b).value == 1);
+    REQUIRE(nothrow_t::counts().moves == 1);
+    REQUIRE(nothrow_t::counts().destructions == 1);
+    REQUIRE(throwing_t::counts().moves == 2);
+    REQUIRE(throwing_t::counts().destructions == 2);
+  }
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  SECTION("Swap with valueless") {
+    struct throw_on_construct {
+      throw_on_construct() { throw std::runtime_error{"throw_on_construct"}; }
+    };
+    using valueless_t = base::variant<nothrow_t, throw_on_construct>;
+    valueless_t a;
+    REQUIRE_THROWS_AS(a.emplace<1>(), std::runtime_error);
+    valueless_t b{nothrow_t{1}};
+    reset();
+    a.swap(b);
+    REQUIRE(base::get<0>(a).value == 1);
+    REQUIRE(b.valueless_by_exception());
+    REQUIRE(nothrow_t::counts().moves == 1);
+    REQUIRE(nothrow_t::counts().destructions == 1);
+  }
+#endif
+}
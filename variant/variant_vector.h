@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "internal/tag_scan.h"
+#include "variant.h"
+
+namespace base {
+
+// Sequence of variants of `Ts...` stored as structure of arrays: dense array of
+// tags (alternative numbers), array of positions in the per-alternative pools
+// and one `std::vector` pool per alternative.
+//
+// Tags take the smallest unsigned type able to hold them, so tag scans
+// (`find_first`, `count`) touch only a fraction of the memory and are
+// vectorized. `for_each_alternative` processes elements pool by pool, i.e.
+// all the elements of one type in a row, without any per-element dispatch.
+//
+// Elements are appended and removed at the back only; their alternative can't
+// be changed in place. Each pool holds at most 2^32 - 1 elements.
+template <class... Ts>
+class variant_vector {
+  static_assert(sizeof...(Ts) > 0, "variant type list cannot be empty.");
+
+  using tag_type = detail::index_type_t<sizeof...(Ts)>;
+  using slot_type = std::uint32_t;
+
+  template <std::size_t I>
+  using alternative_t = base::type_pack_element_t<I, Ts...>;
+
+ public:
+  using value_type = variant<Ts...>;
+
+  // -------------------- CAPACITY --------------------
+
+  std::size_t size() const noexcept { return tags_.size(); }
+  bool empty() const noexcept { return tags_.empty(); }
+
+  void reserve(std::size_t n) {
+    tags_.reserve(n);
+    slots_.reserve(n);
+  }
+
+  // -------------------- MODIFIERS --------------------
+
+  template <std::size_t I, class... Args>
+  alternative_t<I>& emplace_back(Args&&... args) {
+    auto& pool = std::get<I>(pools_);
+    if (pool.size() >= std::numeric_limits<slot_type>::max()) {
+      detail::raise<std::length_error>("variant_vector pool is full");
+    }
+    tags_.push_back(static_cast<tag_type>(I));
+    BASE_VARIANT_TRY {
+      slots_.push_back(static_cast<slot_type>(pool.size()));
+      pool.emplace_back(std::forward<Args>(args)...);
+    } BASE_VARIANT_CATCH_ALL {
+      tags_.pop_back();
+      slots_.resize(tags_.size());
+      BASE_VARIANT_RETHROW;
+    }
+    return pool.back();
+  }
+
+  template <class T, class... Args,
+            std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, T&> emplace_back(Args&&... args) {
+    return emplace_back<index>(std::forward<Args>(args)...);
+  }
+
+  template <class T, class TDec = std::decay_t<T>,
+            std::size_t index = detail::index_of<TDec, Ts...>>
+  std::enable_if_t<index != variant_npos> push_back(T&& value) {
+    emplace_back<index>(std::forward<T>(value));
+  }
+
+  // Throws `bad_variant_access` if `value` is valueless.
+  void push_back(const value_type& value) {
+    base::visit([this](const auto& x) { push_back(x); }, value);
+  }
+
+  // Last element is always the last one in its pool.
+  void pop_back() {
+    detail::dispatch_index<void, sizeof...(Ts)>(tags_.back(), [this](auto i) {
+      std::get<decltype(i)::value>(pools_).pop_back();
+    });
+    tags_.pop_back();
+    slots_.pop_back();
+  }
+
+  void clear() noexcept {
+    tags_.clear();
+    slots_.clear();
+    clear_pools(std::index_sequence_for<Ts...>{});
+  }
+
+  // -------------------- ELEMENT ACCESS --------------------
+
+  // Alternative number of element `i`.
+  std::size_t index(std::size_t i) const noexcept { return tags_[i]; }
+
+  template <std::size_t I>
+  alternative_t<I>& get(std::size_t i) {
+    if (tags_[i] != I) {
+      detail::raise<bad_variant_access>();
+    }
+    return std::get<I>(pools_)[slots_[i]];
+  }
+
+  template <std::size_t I>
+  const alternative_t<I>& get(std::size_t i) const {
+    if (tags_[i] != I) {
+      detail::raise<bad_variant_access>();
+    }
+    return std::get<I>(pools_)[slots_[i]];
+  }
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, T&> get(std::size_t i) {
+    return get<index>(i);
+  }
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, const T&> get(std::size_t i) const {
+    return get<index>(i);
+  }
+
+  template <std::size_t I>
+  alternative_t<I>* get_if(std::size_t i) noexcept {
+    return tags_[i] == I ? &std::get<I>(pools_)[slots_[i]] : nullptr;
+  }
+
+  template <std::size_t I>
+  const alternative_t<I>* get_if(std::size_t i) const noexcept {
+    return tags_[i] == I ? &std::get<I>(pools_)[slots_[i]] : nullptr;
+  }
+
+  // Copy of element `i` as a standalone variant.
+  value_type operator[](std::size_t i) const {
+    return detail::dispatch_index<value_type, sizeof...(Ts)>(
+        tags_[i], [&](auto index) {
+          constexpr std::size_t I = decltype(index)::value;
+          return value_type{in_place_index<I>,
+                            std::get<I>(pools_)[slots_[i]]};
+        });
+  }
+
+  // Calls `f` with alternative held by element `i`. Result type is the one
+  // returned for alternative 0, the others are converted to it.
+  template <class F>
+  decltype(auto) visit(F&& f, std::size_t i) {
+    return visit_impl(*this, std::forward<F>(f), i);
+  }
+
+  template <class F>
+  decltype(auto) visit(F&& f, std::size_t i) const {
+    return visit_impl(*this, std::forward<F>(f), i);
+  }
+
+  // Calls `f` for every element, grouped by alternative: first for all the
+  // elements holding alternative 0 (in the insertion order), then for all
+  // holding alternative 1 and so on.
+  template <class F>
+  void for_each_alternative(F&& f) {
+    for_each_impl(*this, f, std::index_sequence_for<Ts...>{});
+  }
+
+  template <class F>
+  void for_each_alternative(F&& f) const {
+    for_each_impl(*this, f, std::index_sequence_for<Ts...>{});
+  }
+
+  // All the elements holding alternative `I`, in the insertion order.
+  template <std::size_t I>
+  const std::vector<alternative_t<I>>& alternatives() const noexcept {
+    return std::get<I>(pools_);
+  }
+
+  // -------------------- LOOKUP --------------------
+
+  // Number of elements holding alternative `I`.
+  template <std::size_t I>
+  std::size_t count() const noexcept {
+    return std::get<I>(pools_).size();
+  }
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, std::size_t> count() const noexcept {
+    return count<index>();
+  }
+
+  // Number of elements in `[first, last)` holding alternative `I`.
+  template <std::size_t I>
+  std::size_t count(std::size_t first, std::size_t last) const noexcept {
+    return detail::count_tag(tags_.data(), first, last,
+                             static_cast<tag_type>(I));
+  }
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, std::size_t> count(
+      std::size_t first, std::size_t last) const noexcept {
+    return count<index>(first, last);
+  }
+
+  // Position of the first element starting from `from`, which holds
+  // alternative `I`, or `variant_npos`.
+  template <std::size_t I>
+  std::size_t find_first(std::size_t from = 0) const noexcept {
+    const std::size_t result = detail::find_tag(
+        tags_.data(), from, tags_.size(), static_cast<tag_type>(I));
+    return result == tags_.size() ? variant_npos : result;
+  }
+
+  template <class T, std::size_t index = detail::index_of<T, Ts...>>
+  std::enable_if_t<index != variant_npos, std::size_t> find_first(
+      std::size_t from = 0) const noexcept {
+    return find_first<index>(from);
+  }
+
+ private:
+  template <class Self, class F>
+  static decltype(auto) visit_impl(Self& self, F&& f, std::size_t i) {
+    using R = base::invoke_result_t<F&&, decltype(self.template get<0>(0))>;
+    return detail::dispatch_index<R, sizeof...(Ts)>(
+        self.tags_[i], [&](auto index) -> R {
+          constexpr std::size_t I = decltype(index)::value;
+          return std::forward<F>(f)(
+              std::get<I>(self.pools_)[self.slots_[i]]);
+        });
+  }
+
+  template <class Self, class F, std::size_t... Is>
+  static void for_each_impl(Self& self, F& f, std::index_sequence<Is...>) {
+    const int dummy[] = {
+        (for_each_in_pool(std::get<Is>(self.pools_), f), 0)...};
+    (void)dummy;
+  }
+
+  template <class Pool, class F>
+  static void for_each_in_pool(Pool& pool, F& f) {
+    for (auto& value : pool) {
+      f(value);
+    }
+  }
+
+  template <std::size_t... Is>
+  void clear_pools(std::index_sequence<Is...>) noexcept {
+    const int dummy[] = {(std::get<Is>(pools_).clear(), 0)...};
+    (void)dummy;
+  }
+
+  std::vector<tag_type> tags_;
+  std::vector<slot_type> slots_;
+  std::tuple<std::vector<Ts>...> pools_;
+};
+
+}  // namespace base
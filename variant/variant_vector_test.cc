@@ -0,0 +1,103 @@
+#include "variant_vector.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "test_util.h"
+
+namespace {
+
+struct throw_on_construct {
+#if BASE_VARIANT_HAS_EXCEPTIONS
+  throw_on_construct() { throw std::runtime_error{"throw_on_construct"}; }
+#endif
+};
+
+using base::testing::type_name;
+
+using vector_t = base::variant_vector<int, std::string, double>;
+
+vector_t make_vector(std::size_t n) {
+  return base::testing::make_mixed_range<vector_t>(n);
+}
+
+}  // namespace
+
+TEST_CASE("Variant vector access test", "[variant_vector]") {
+  auto v = make_vector(6);
+  REQUIRE(v.size() == 6);
+  REQUIRE(v.index(0) == 0);
+  REQUIRE(v.index(4) == 1);
+  REQUIRE(v.get<int>(3) == 3);
+  REQUIRE(v.get<1>(1) == "1");
+  REQUIRE(v.get<double>(5) == 2.5);
+  REQUIRE_RAISES_AS(v.get<int>(1), base::bad_variant_access);
+  REQUIRE(v.get_if<1>(0) == nullptr);
+  REQUIRE(*v.get_if<1>(4) == "4");
+  REQUIRE(v[2] == base::variant<int, std::string, double>{1.0});
+
+  v.get<std::string>(1) = "one";
+  REQUIRE(v.get<1>(1) == "one");
+  REQUIRE(v.visit(type_name{}, 1) == "string");
+  REQUIRE(v.visit([](auto& x) { return sizeof(x); }, 5) == sizeof(double));
+
+  v.push_back(base::variant<int, std::string, double>{std::string{"last"}});
+  REQUIRE(v.get<std::string>(6) == "last");
+  v.pop_back();
+  v.pop_back();
+  REQUIRE(v.size() == 5);
+  REQUIRE(v.count<double>() == 1);
+  REQUIRE(v.alternatives<2>().size() == 1);
+
+  v.clear();
+  REQUIRE(v.empty());
+  REQUIRE(v.count<int>() == 0);
+}
+
+TEST_CASE("Variant vector iteration test", "[variant_vector]") {
+  const auto v = make_vector(7);
+
+  std::vector<std::string> order;
+  v.for_each_alternative(
+      [&order](const auto& x) { order.push_back(type_name{}(x)); });
+  REQUIRE(order == std::vector<std::string>{"int", "int", "int", "string",
+                                            "string", "double", "double"});
+  REQUIRE(v.alternatives<0>() == std::vector<int>{0, 3, 6});
+}
+
+TEST_CASE("Variant vector lookup test", "[variant_vector]") {
+  // Long enough to go through the vectorized part of the scan.
+  auto v = make_vector(100);
+  REQUIRE(v.count<int>() == 34);
+  REQUIRE(v.count<std::string>(0, 10) == 3);
+  REQUIRE(v.count<2>(50, 100) == 17);
+
+  REQUIRE(v.find_first<int>() == 0);
+  REQUIRE(v.find_first<double>() == 2);
+  REQUIRE(v.find_first<double>(3) == 5);
+  REQUIRE(v.find_first<double>(98) == 98);
+  REQUIRE(v.find_first<double>(99) == base::variant_npos);
+
+  base::variant_vector<int, char> sparse;
+  for (int i = 0; i < 70; ++i) {
+    sparse.push_back(i);
+  }
+  sparse.push_back('c');
+  REQUIRE(sparse.find_first<char>() == 70);
+  REQUIRE(sparse.find_first<char>(17) == 70);
+  REQUIRE(sparse.count<int>(0, sparse.size()) == 70);
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Variant vector exception safety test", "[variant_vector]") {
+  base::variant_vector<int, throw_on_construct> v;
+  v.push_back(1);
+  REQUIRE_THROWS_AS(v.emplace_back<throw_on_construct>(), std::runtime_error);
+  REQUIRE(v.size() == 1);
+  REQUIRE(v.find_first<throw_on_construct>() == base::variant_npos);
+  v.push_back(2);
+  REQUIRE(v.get<int>(1) == 2);
+}
+#endif
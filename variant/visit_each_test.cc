@@ -0,0 +1,102 @@
+#include "visit_each.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "never_empty_variant.h"
+#include "test_util.h"
+
+namespace {
+
+using base::testing::throw_on_move;
+using base::testing::type_name;
+
+using var_t = base::variant<int, std::string, double>;
+
+constexpr std::size_t min_bucketed_size =
+    base::detail::min_bucketed_visit_size;
+
+std::vector<var_t> make_range(std::size_t n) {
+  return base::testing::make_mixed_range<std::vector<var_t>>(n);
+}
+
+struct type_rank {
+  int operator()(int) const { return 0; }
+  int operator()(const std::string&) const { return 1; }
+  int operator()(double) const { return 2; }
+};
+
+}  // namespace
+
+TEST_CASE("Visit each test", "[visit_each]") {
+  for (const std::size_t n : {std::size_t{0}, std::size_t{5},
+                              min_bucketed_size - 1, min_bucketed_size,
+                              2 * min_bucketed_size}) {
+    auto range = make_range(n);
+    std::vector<int> seen;
+    base::visit_each(range,
+                     [&](const auto& x) { seen.push_back(type_rank{}(x)); });
+    REQUIRE(seen.size() == n);
+    // Grouped by alternative from the threshold on, in the range order below
+    // it.
+    if (n >= min_bucketed_size) {
+      REQUIRE(std::is_sorted(seen.begin(), seen.end()));
+    } else {
+      for (std::size_t i = 0; i < n; ++i) {
+        REQUIRE(seen[i] == static_cast<int>(i % 3));
+      }
+    }
+  }
+
+  auto range = make_range(100);
+  base::visit_each(range, [](auto& x) { x += x; });
+  REQUIRE(base::get<int>(range[3]) == 6);
+  REQUIRE(base::get<std::string>(range[4]) == "44");
+  REQUIRE(base::get<double>(range[5]) == 5.0);
+
+  const auto& const_range = range;
+  int ints = 0;
+  base::visit_each(const_range, [&](const auto& x) {
+    ints += std::is_same<std::decay_t<decltype(x)>, int>::value;
+  });
+  REQUIRE(ints == 34);
+}
+
+TEST_CASE("Visit transform test", "[visit_each]") {
+  for (const std::size_t n : {0, 5, 100}) {
+    const auto range = make_range(n);
+    std::vector<std::string> names(n);
+    REQUIRE(base::visit_transform(range, names.begin(), type_name{}) ==
+            names.end());
+    for (std::size_t i = 0; i < n; ++i) {
+      REQUIRE(names[i] == base::visit(type_name{}, range[i]));
+    }
+  }
+
+  const base::never_empty_variant<int, double> values[] = {
+      1, 2.5, 3, 4.5, 5, 6.5, 7, 8.5, 9, 10.5, 11, 12.5, 13, 14.5, 15, 16.5};
+  double doubled[16];
+  base::visit_transform(values, doubled, [](auto x) { return 2.0 * x; });
+  REQUIRE(doubled[0] == 2.0);
+  REQUIRE(doubled[15] == 33.0);
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Visit each valueless test", "[visit_each]") {
+  // Both below and above the bucketing threshold.
+  for (const std::size_t n : {std::size_t{20}, 2 * min_bucketed_size}) {
+    std::vector<base::variant<int, throw_on_move>> range(n);
+    REQUIRE_THROWS_AS(range[7].emplace<throw_on_move>(throw_on_move{}),
+                      std::runtime_error);
+    REQUIRE(range[7].valueless_by_exception());
+
+    int calls = 0;
+    REQUIRE_THROWS_AS(base::visit_each(range, [&](const auto&) { ++calls; }),
+                      base::bad_variant_access);
+    REQUIRE(calls == 0);
+  }
+}
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "variant.h"
+
+namespace base {
+
+namespace detail {
+
+template <class T, class Alternatives>
+struct expected_index_in;
+
+template <class T, class... Ts>
+struct expected_index_in<T, base::type_pack<Ts...>>
+    : std::integral_constant<std::size_t, alternative_index<T, Ts...>> {};
+
+// Index of alternative `T` of variant `V` (or of a class derived from it).
+template <class T, class V>
+constexpr std::size_t expected_index =
+    expected_index_in<T, variant_alternatives_t<V>>::value;
+
+template <class R, class F, class V>
+constexpr R visit_expected(base::type_pack<>, F&& f, V&& v) {
+  return base::visit<R>(std::forward<F>(f), std::forward<V>(v));
+}
+
+template <class R, class T, class... Ts, class F, class V>
+constexpr R visit_expected(base::type_pack<T, Ts...>, F&& f, V&& v) {
+  constexpr std::size_t I = expected_index<T, std::decay_t<V>>;
+  static_assert(I != variant_npos,
+                "visit_expect types must be alternatives of the variant.");
+  if (BASE_VARIANT_LIKELY(v.index() == I)) {
+    return invoke_r<R>::call(std::forward<F>(f),
+                             variant_accessor::get<I>(std::forward<V>(v)));
+  }
+  return visit_expected<R>(base::type_pack<Ts...>{}, std::forward<F>(f),
+                           std::forward<V>(v));
+}
+
+}  // namespace detail
+
+// Same as `visit(f, v)`, but first checks whether `v` holds one of the
+// `Expected` alternatives (in order) with branches predicted to be taken, and
+// calls `f` on it directly. Other alternatives go through the usual dispatch.
+//
+// Pays off when a few alternatives make up most of the visits of `v`, e.g.
+// `visit_expect<double>(eval_visitor{}, node)`. Visit sites to tune may be
+// profiled with `BASE_VARIANT_VISIT` (see visit_profile.h).
+template <class... Expected, class F, class V,
+          class Result = detail::visit_result_t<F&&, V&&>>
+constexpr Result visit_expect(F&& f, V&& v) {
+  return detail::visit_expected<Result>(base::type_pack<Expected...>{},
+                                        std::forward<F>(f), std::forward<V>(v));
+}
+
+}  // namespace base
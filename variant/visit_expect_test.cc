@@ -0,0 +1,76 @@
+#include "visit_expect.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "catch2/catch_all.hpp"
+#include "never_empty_variant.h"
+#include "test_util.h"
+
+namespace {
+
+using base::testing::category;
+using base::testing::throw_on_move;
+
+using var_t = base::variant<int, std::string, double, throw_on_move>;
+
+struct describe {
+  std::string operator()(int value) const { return std::to_string(value); }
+  std::string operator()(const std::string& value) const { return value; }
+  std::string operator()(double) const { return "double"; }
+  std::string operator()(const throw_on_move&) const { return "throw"; }
+};
+
+}  // namespace
+
+TEST_CASE("Visit expect results") {
+  const var_t values[] = {var_t{1}, var_t{std::string{"s"}}, var_t{2.0},
+                          var_t{base::in_place_index<3>}};
+  for (const var_t& v : values) {
+    const std::string expected = base::visit(describe{}, v);
+    REQUIRE(base::visit_expect<>(describe{}, v) == expected);
+    REQUIRE(base::visit_expect<int>(describe{}, v) == expected);
+    REQUIRE(base::visit_expect<double, std::string>(describe{}, v) ==
+            expected);
+  }
+}
+
+TEST_CASE("Visit expect categories") {
+  var_t v{1};
+  const var_t& cv = v;
+  REQUIRE(base::visit_expect<int>(category{}, v) == 0);
+  REQUIRE(base::visit_expect<int>(category{}, cv) == 1);
+  REQUIRE(base::visit_expect<int>(category{}, std::move(v)) == 2);
+
+  base::visit_expect<int>([](auto& value) { value = {}; }, v);
+  REQUIRE(base::get<int>(v) == 0);
+
+  var_t s{std::string{"moved"}};
+  std::string target;
+  base::visit_expect<std::string>(
+      [&target](auto&& value) { target = describe{}(std::move(value)); },
+      std::move(s));
+  REQUIRE(target == "moved");
+}
+
+#if BASE_VARIANT_HAS_EXCEPTIONS
+TEST_CASE("Visit expect valueless") {
+  base::variant<int, throw_on_move> v{1};
+  REQUIRE_THROWS(v.emplace<throw_on_move>(throw_on_move{}));
+  REQUIRE(v.valueless_by_exception());
+  REQUIRE_THROWS_AS(base::visit_expect<int>(category{}, v),
+                    base::bad_variant_access);
+}
+#endif
+
+TEST_CASE("Visit expect never empty") {
+  using never_empty_t = base::never_empty_variant<int, std::string, double>;
+  const never_empty_t values[] = {never_empty_t{1},
+                                  never_empty_t{std::string{"s"}},
+                                  never_empty_t{2.0}};
+  for (const never_empty_t& v : values) {
+    REQUIRE(base::visit_expect<std::string>(describe{}, v) ==
+            base::visit(describe{}, v));
+  }
+}
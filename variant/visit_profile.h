@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "variant.h"
+
+// Counts dispatched alternatives at every `BASE_VARIANT_VISIT` site (when set
+// to 1), so the hot ones can be found with `dump_visit_profile` and passed to
+// `visit_expect`. Otherwise `BASE_VARIANT_VISIT` is just `visit`.
+#ifndef BASE_VARIANT_PROFILE_VISITS
+#define BASE_VARIANT_PROFILE_VISITS 0
+#endif
+
+namespace base {
+
+// Dispatch counts of a single visit site. Sites register themselves in a
+// global list on construction and are never unlinked: they're immortal (made
+// with `new` and can't be destroyed), so profiles may be dumped or reset at
+// any point, including static destruction at exit.
+class visit_site {
+ public:
+  visit_site(const char* file, int line, std::size_t alternatives)
+      : file_(file),
+        line_(line),
+        alternatives_(alternatives),
+        counts_(new std::atomic<std::uint64_t>[alternatives + 1]) {
+    for (std::size_t i = 0; i <= alternatives_; ++i) {
+      counts_[i].store(0, std::memory_order_relaxed);
+    }
+    next_ = head().load(std::memory_order_relaxed);
+    while (!head().compare_exchange_weak(next_, this,
+                                         std::memory_order_release)) {
+    }
+  }
+
+  visit_site(const visit_site&) = delete;
+  visit_site& operator=(const visit_site&) = delete;
+  ~visit_site() = delete;
+
+  // First registered site, others are linked by `next`.
+  static const visit_site* first() noexcept {
+    return head().load(std::memory_order_acquire);
+  }
+
+  const visit_site* next() const noexcept { return next_; }
+
+  const char* file() const noexcept { return file_; }
+  int line() const noexcept { return line_; }
+  std::size_t alternatives() const noexcept { return alternatives_; }
+
+  // Visits of alternative `i`, or of valueless variants for `variant_npos`.
+  std::uint64_t count(std::size_t i) const noexcept {
+    return counts_[i + 1].load(std::memory_order_relaxed);
+  }
+
+  void record(std::size_t i) noexcept {
+    counts_[i + 1].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void reset() noexcept {
+    for (std::size_t i = 0; i <= alternatives_; ++i) {
+      counts_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+ private:
+  static std::atomic<visit_site*>& head() noexcept {
+    static std::atomic<visit_site*> first{nullptr};
+    return first;
+  }
+
+  const char* file_;
+  int line_;
+  std::size_t alternatives_;
+  std::atomic<std::uint64_t>* const counts_;
+  visit_site* next_;
+};
+
+// Writes counts of every visit site, alternatives ordered from the most
+// frequent one, e.g.
+//
+//   evaluator/evaluator.h:184: 1000 visits
+//     alternative 0: 900 (90%)
+//     alternative 1: 100 (10%)
+inline void dump_visit_profile(std::ostream& out) {
+  for (auto* site = visit_site::first(); site != nullptr;
+       site = site->next()) {
+    std::vector<std::pair<std::uint64_t, std::size_t>> counts;
+    std::uint64_t total = 0;
+    // Starts from the valueless count: `variant_npos + 1` wraps to 0.
+    for (std::size_t i = variant_npos; i != site->alternatives(); ++i) {
+      counts.emplace_back(site->count(i), i);
+      total += site->count(i);
+    }
+    std::stable_sort(counts.begin(), counts.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.first > b.first;
+                     });
+    out << site->file() << ':' << site->line() << ": " << total
+        << " visits\n";
+    for (const auto& count : counts) {
+      if (count.first == 0) {
+        break;
+      }
+      out << "  ";
+      if (count.second == variant_npos) {
+        out << "valueless";
+      } else {
+        out << "alternative " << count.second;
+      }
+      out << ": " << count.first << " (" << count.first * 100 / total
+          << "%)\n";
+    }
+  }
+}
+
+inline void reset_visit_profile() noexcept {
+  for (auto* site = visit_site::first(); site != nullptr;
+       site = site->next()) {
+    const_cast<visit_site*>(site)->reset();
+  }
+}
+
+namespace detail {
+
+// Records the alternative of `v`, the first of the visited variants.
+template <class F, class V, class... Vs>
+constexpr decltype(auto) profiled_visit(visit_site& site, F&& f, V&& v,
+                                        Vs&&... vs) {
+  site.record(v.index());
+  return base::visit(std::forward<F>(f), std::forward<V>(v),
+                     std::forward<Vs>(vs)...);
+}
+
+}  // namespace detail
+
+}  // namespace base
+
+// `visit(f, v, vs...)` of one or more variants, which counts the visited
+// alternatives of the first variant `v` at this site in the profiling mode.
+// Both modes take the same arguments: `f` and at least one variant. The
+// generic lambda gets a separate site for every expansion of the macro and
+// every variant type visited there.
+#if BASE_VARIANT_PROFILE_VISITS
+#define BASE_VARIANT_VISIT(f, ...)                                          \
+  ([](auto&& base_variant_f, auto&& base_variant_v,                         \
+      auto&&... base_variant_vs) -> decltype(auto) {                        \
+    using base_variant_v_t = std::decay_t<decltype(base_variant_v)>;        \
+    static ::base::visit_site& base_variant_site =                          \
+        *new ::base::visit_site{                                            \
+            __FILE__, __LINE__,                                             \
+            ::base::detail::alternatives_count<base_variant_v_t>};          \
+    return ::base::detail::profiled_visit(                                  \
+        base_variant_site,                                                  \
+        std::forward<decltype(base_variant_f)>(base_variant_f),             \
+        std::forward<decltype(base_variant_v)>(base_variant_v),             \
+        std::forward<decltype(base_variant_vs)>(base_variant_vs)...);       \
+  }(f, __VA_ARGS__))
+#else
+#define BASE_VARIANT_VISIT(f, ...) ::base::visit(f, __VA_ARGS__)
+#endif
@@ -0,0 +1,130 @@
+#define BASE_VARIANT_PROFILE_VISITS 1
+
+#include "visit_profile.h"
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include "catch2/catch_all.hpp"
+#include "never_empty_variant.h"
+
+namespace {
+
+using var_t = base::variant<int, std::string, double>;
+
+struct derived_var_t : var_t {
+  using var_t::var_t;
+};
+
+// Sites are never destroyed, so they can be dumped during static destruction.
+static_assert(!std::is_destructible<base::visit_site>::value, "");
+
+static_assert(base::detail::alternatives_count<derived_var_t> == 3, "");
+static_assert(
+    base::detail::alternatives_count<base::never_empty_variant<int, double>> ==
+        2,
+    "");
+
+// Dumps the profile after all the function-local statics are destroyed.
+struct dump_at_exit {
+  ~dump_at_exit() {
+    std::ostringstream out;
+    base::dump_visit_profile(out);
+  }
+} dump_at_exit_instance;
+
+struct size_of_value {
+  std::size_t operator()(int) const { return sizeof(int); }
+  std::size_t operator()(const std::string& value) const {
+    return value.size();
+  }
+  std::size_t operator()(double) const { return sizeof(double); }
+};
+
+const base::visit_site* find_site(int line) {
+  for (auto* site = base::visit_site::first(); site != nullptr;
+       site = site->next()) {
+    if (site->line() == line) {
+      return site;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+TEST_CASE("Visit profile counts alternatives") {
+  base::reset_visit_profile();
+  const var_t values[] = {var_t{1}, var_t{2.0}, var_t{std::string{"abc"}},
+                          var_t{3}};
+  std::size_t total = 0;
+  int line = 0;
+  for (int i = 0; i < 10; ++i) {
+    for (const var_t& v : values) {
+      total += BASE_VARIANT_VISIT(size_of_value{}, v);
+      line = __LINE__ - 1;
+    }
+  }
+  REQUIRE(total == 10 * (4 + 8 + 3 + 4));
+
+  const base::visit_site* site = find_site(line);
+  REQUIRE(site != nullptr);
+  REQUIRE(std::string{site->file()}.find("visit_profile_test.cc") !=
+          std::string::npos);
+  REQUIRE(site->alternatives() == 3);
+  REQUIRE(site->count(0) == 20);
+  REQUIRE(site->count(1) == 10);
+  REQUIRE(site->count(2) == 10);
+  REQUIRE(site->count(base::variant_npos) == 0);
+
+  std::ostringstream dump;
+  base::dump_visit_profile(dump);
+  const std::string expected = ":" + std::to_string(line) +
+                               ": 40 visits\n"
+                               "  alternative 0: 20 (50%)\n"
+                               "  alternative 1: 10 (25%)\n"
+                               "  alternative 2: 10 (25%)\n";
+  REQUIRE(dump.str().find(expected) != std::string::npos);
+
+  base::reset_visit_profile();
+  REQUIRE(site->count(0) == 0);
+}
+
+TEST_CASE("Visit profile sites") {
+  var_t v{std::string{"value"}};
+  // Every expansion of the macro is a separate site.
+  const auto first = BASE_VARIANT_VISIT(size_of_value{}, v);
+  const int first_line = __LINE__ - 1;
+  const auto second = BASE_VARIANT_VISIT(
+      [](auto& value) -> std::size_t { return sizeof(value); }, v);
+  const int second_line = __LINE__ - 2;
+
+  REQUIRE(first == 5);
+  REQUIRE(second == sizeof(std::string));
+  REQUIRE(find_site(first_line)->count(1) == 1);
+  REQUIRE(find_site(second_line) != nullptr);
+  REQUIRE(find_site(second_line) != find_site(first_line));
+}
+
+TEST_CASE("Visit profile of several variants") {
+  const var_t a{std::string{"abc"}};
+  const base::never_empty_variant<int, double> b{2.5};
+  const std::size_t offset = 1;
+  // Lambda captures aren't parenthesized, so the macro must keep commas in
+  // `f` intact.
+  const auto size = BASE_VARIANT_VISIT(
+      [offset, &a](const auto& x, auto y) {
+        return offset + size_of_value{}(x) + static_cast<std::size_t>(y) +
+               a.index();
+      },
+      a, b);
+  const int line = __LINE__ - 6;
+
+  REQUIRE(size == 1 + 3 + 2 + 1);
+  // Only the first variant is counted.
+  const base::visit_site* site = find_site(line);
+  REQUIRE(site != nullptr);
+  REQUIRE(site->alternatives() == 3);
+  REQUIRE(site->count(1) == 1);
+}